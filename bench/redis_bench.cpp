@@ -0,0 +1,633 @@
+//뼰ӦתĻ׼
+//ʱ(ns/op),ÿÿβĶѷ(allocs/op)ֽ(bytes/op)
+//˵Ĭصredis-server(REDIS_SERVERָ·),REDIS_BENCH_HOSTʱΪеķ
+//
+//	redis_bench --benchmark_filter=decode
+//	REDIS_BENCH_HOST=127.0.0.1 REDIS_BENCH_PORT=6379 redis_bench --benchmark_filter=e2e
+
+#include "redis_ex.h"
+#include <benchmark/benchmark.h>
+#include <new>
+#include <memory>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#endif
+
+using namespace tc_redis;
+
+//ѷ,operator newhiredisķ
+static std::atomic<uint64_t> g_allocs(0);
+static std::atomic<uint64_t> g_bytes(0);
+
+static void count_alloc(size_t _size)
+{
+	g_allocs.fetch_add(1, std::memory_order_relaxed);
+	g_bytes.fetch_add(_size, std::memory_order_relaxed);
+}
+
+void* operator new(size_t _size)
+{
+	count_alloc(_size);
+	void* p = malloc(_size == 0 ? 1 : _size);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+void* operator new(size_t _size, const std::nothrow_t&) noexcept
+{
+	count_alloc(_size);
+	return malloc(_size == 0 ? 1 : _size);
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { free(p); }
+
+#if defined(HIREDIS_MAJOR) && HIREDIS_MAJOR >= 1
+static void* counted_malloc(size_t _size) { count_alloc(_size); return malloc(_size); }
+static void* counted_calloc(size_t _count, size_t _size) { count_alloc(_count * _size); return calloc(_count, _size); }
+static void* counted_realloc(void* p, size_t _size) { count_alloc(_size); return realloc(p, _size); }
+static char* counted_strdup(const char* s) { count_alloc(strlen(s) + 1); return strdup(s); }
+static hiredisAllocFuncs g_hiredis_allocs = { counted_malloc, counted_calloc, counted_realloc, counted_strdup, free };
+#endif
+
+//ʱѭڼķÿβļ
+class alloc_counter
+{
+protected:
+	benchmark::State& state;
+	uint64_t allocs;
+	uint64_t bytes;
+public:
+	explicit alloc_counter(benchmark::State& _state) :
+		state(_state), allocs(g_allocs.load()), bytes(g_bytes.load())
+	{
+	}
+	~alloc_counter()
+	{
+		state.counters["allocs/op"] = benchmark::Counter((double)(g_allocs.load() - allocs), benchmark::Counter::kAvgIterations);
+		state.counters["bytes/op"] = benchmark::Counter((double)(g_bytes.load() - bytes), benchmark::Counter::kAvgIterations);
+	}
+};
+
+//ϳɵĻӦ,ṹhiredisͬ,ɱ̷ͷ
+//ֶڶַŻ֮,ֵ,볣hash
+class synthetic_reply
+{
+protected:
+	redisReply* root;
+
+	static redisReply* make(int _type)
+	{
+		redisReply* _reply = (redisReply*)calloc(1, sizeof(redisReply));
+		_reply->type = _type;
+		return _reply;
+	}
+
+	static void destroy(redisReply* _reply)
+	{
+		for (size_t i = 0; i < _reply->elements; i++) {
+			destroy(_reply->element[i]);
+		}
+		free(_reply->element);
+		free(_reply->str);
+		free(_reply);
+	}
+
+	synthetic_reply(const synthetic_reply&) = delete;
+	synthetic_reply& operator =(const synthetic_reply&) = delete;
+public:
+	explicit synthetic_reply(redisReply* _root) :root(_root) {
+	}
+	~synthetic_reply() {
+		destroy(root);
+	}
+
+	static redisReply* string(const char* _format, size_t i)
+	{
+		char tmp[64];
+		int n = snprintf(tmp, sizeof(tmp), _format, i);
+		redisReply* _reply = make(REDIS_REPLY_STRING);
+		_reply->str = (char*)malloc(n + 1);
+		memcpy(_reply->str, tmp, n + 1);
+		_reply->len = n;
+		return _reply;
+	}
+
+	static redisReply* integer(int64_t _v)
+	{
+		redisReply* _reply = make(REDIS_REPLY_INTEGER);
+		_reply->integer = _v;
+		return _reply;
+	}
+
+	static redisReply* array(size_t n)
+	{
+		redisReply* _reply = make(REDIS_REPLY_ARRAY);
+		_reply->element = (redisReply**)calloc(n == 0 ? 1 : n, sizeof(redisReply*));
+		_reply->elements = n;
+		return _reply;
+	}
+
+	static redisReply* field(size_t i) { return string("field:%08zu", i); }
+	static redisReply* value(size_t i) { return string("value:%08zu:0123456789abcdef", i); }
+
+	//nֵ,LRANGE,SMEMBERS
+	static redisReply* strings(size_t n)
+	{
+		redisReply* _reply = array(n);
+		for (size_t i = 0; i < n; i++) {
+			_reply->element[i] = value(i);
+		}
+		return _reply;
+	}
+
+	//n
+	static redisReply* integers(size_t n)
+	{
+		redisReply* _reply = array(n);
+		for (size_t i = 0; i < n; i++) {
+			_reply->element[i] = integer((int64_t)i * 7919);
+		}
+		return _reply;
+	}
+
+	//nֶμֵƽ,HGETALL
+	static redisReply* flat_pairs(size_t n)
+	{
+		redisReply* _reply = array(n * 2);
+		for (size_t i = 0; i < n; i++) {
+			_reply->element[i * 2] = field(i);
+			_reply->element[i * 2 + 1] = value(i);
+		}
+		return _reply;
+	}
+
+	//nԪ
+	static redisReply* nested_pairs(size_t n)
+	{
+		redisReply* _reply = array(n);
+		for (size_t i = 0; i < n; i++) {
+			redisReply* _pair = array(2);
+			_pair->element[0] = field(i);
+			_pair->element[1] = value(i);
+			_reply->element[i] = _pair;
+		}
+		return _reply;
+	}
+
+	//ûӦ,ͷ
+	redis_reply reply()const {
+		return redis_reply(root, std::shared_ptr<redisReply>(), "BENCH");
+	}
+};
+
+typedef std::unique_ptr<redisContext, void(*)(redisContext*)> context_ptr;
+
+//˵ķ
+//ĬREDIS_BENCH_PORT(Ĭ16379)redis-server,˳ʱ
+class bench_server
+{
+protected:
+	std::string host;
+	int port;
+	std::string error;
+#ifndef _WIN32
+	pid_t pid;
+#endif
+
+	static const char* env(const char* _name, const char* _default) {
+		const char* _v = getenv(_name);
+		return _v != nullptr && *_v != 0 ? _v : _default;
+	}
+
+	bool ping()
+	{
+		context_ptr _context(redisConnect(host.c_str(), port), redisFree);
+		if (_context == nullptr || _context->err != 0) {
+			return false;
+		}
+		redisReply* _reply = (redisReply*)redisCommand(_context.get(), "PING");
+		bool _ok = _reply != nullptr && _reply->type == REDIS_REPLY_STATUS;
+		if (_reply != nullptr) {
+			freeReplyObject(_reply);
+		}
+		return _ok;
+	}
+
+	void start()
+	{
+		if (getenv("REDIS_BENCH_HOST") != nullptr) {
+			if (!ping()) {
+				error = "cannot reach " + host + ":" + std::to_string(port);
+			}
+			return;
+		}
+#ifdef _WIN32
+		error = "set REDIS_BENCH_HOST to run the end-to-end benchmarks";
+#else
+#ifdef REDIS_BENCH_SERVER
+		std::string _server = env("REDIS_SERVER", REDIS_BENCH_SERVER);
+#else
+		std::string _server = env("REDIS_SERVER", "redis-server");
+#endif
+		std::string _port = std::to_string(port);
+		pid = fork();
+		if (pid == 0) {
+			int _null = open("/dev/null", O_WRONLY);
+			dup2(_null, 1);
+			dup2(_null, 2);
+			execlp(_server.c_str(), _server.c_str(), "--port", _port.c_str(), "--bind", host.c_str(),
+				"--save", "", "--appendonly", "no", (char*)nullptr);
+			_exit(127);
+		}
+		if (pid < 0) {
+			error = "fork failed";
+			return;
+		}
+		for (int i = 0; i < 100; i++) {
+			int _status = 0;
+			if (waitpid(pid, &_status, WNOHANG) == pid) {
+				pid = -1;
+				error = _server + " exited before accepting connections";
+				return;
+			}
+			if (ping()) {
+				return;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		}
+		error = _server + " did not answer PING on port " + _port;
+#endif
+	}
+
+	bench_server() :host(env("REDIS_BENCH_HOST", "127.0.0.1")), port(atoi(env("REDIS_BENCH_PORT", "16379")))
+#ifndef _WIN32
+		, pid(-1)
+#endif
+	{
+		start();
+	}
+public:
+	~bench_server()
+	{
+#ifndef _WIN32
+		if (pid > 0) {
+			kill(pid, SIGTERM);
+			waitpid(pid, nullptr, 0);
+		}
+#endif
+	}
+
+	static bench_server& instance() {
+		static bench_server _server;
+		return _server;
+	}
+
+	//ʱ,ؿ
+	context_ptr connect(benchmark::State& _state)
+	{
+		context_ptr _context(nullptr, redisFree);
+		if (error.empty()) {
+			_context.reset(redisConnect(host.c_str(), port));
+			if (_context == nullptr || _context->err != 0) {
+				_context.reset();
+				_state.SkipWithError(("cannot connect to " + host + ":" + std::to_string(port)).c_str());
+			}
+		}
+		else {
+			_state.SkipWithError(error.c_str());
+		}
+		return _context;
+	}
+};
+
+//
+static void encode_variadic(benchmark::State& _state)
+{
+	std::string _key = "bench:hash:0001";
+	alloc_counter _counter(_state);
+	for (auto _ : _state) {
+		redis_command_writer _writer;
+		_writer.command("HSET", _key, "field", 123456789, 3.25);
+		benchmark::DoNotOptimize(_writer.data());
+	}
+}
+BENCHMARK(encode_variadic);
+
+static void encode_argv(benchmark::State& _state)
+{
+	std::vector<std::string> _argv = { "bench:hash:0001", "field", "123456789", "3.25" };
+	alloc_counter _counter(_state);
+	for (auto _ : _state) {
+		redis_command_writer _writer;
+		_writer.command("HSET", _argv);
+		benchmark::DoNotOptimize(_writer.data());
+	}
+}
+BENCHMARK(encode_argv);
+
+//facadeѡ(SORT key BY pattern LIMIT offset count GET pattern DESC ALPHA)ٱ
+//std::vector<std::string>std::to_stringredis_command_argsԱ
+template<bool ARGS>
+static void encode_optional_args(benchmark::State& _state)
+{
+	std::string _key = "bench:list:0001";
+	std::string _by = "weight_*";
+	std::string _get = "object_*";
+	int _offset = 100;
+	unsigned int _count = 50;
+	alloc_counter _counter(_state);
+	for (auto _ : _state) {
+		redis_command_writer _writer;
+		if (ARGS) {
+			redis_command_args _argv;
+			_argv.push_back(_key);
+			_argv.push_back("BY");
+			_argv.push_back(_by);
+			_argv.push_back("LIMIT");
+			_argv.push_back(_offset);
+			_argv.push_back(_count);
+			_argv.push_back("GET");
+			_argv.push_back(_get);
+			_argv.push_back("DESC");
+			_argv.push_back("ALPHA");
+			_writer.command("SORT", _argv);
+		}
+		else {
+			std::vector<std::string> _argv = { _key };
+			_argv.push_back("BY");
+			_argv.push_back(_by);
+			_argv.push_back("LIMIT");
+			_argv.push_back(std::to_string(_offset));
+			_argv.push_back(std::to_string(_count));
+			_argv.push_back("GET");
+			_argv.push_back(_get);
+			_argv.push_back("DESC");
+			_argv.push_back("ALPHA");
+			_writer.command("SORT", _argv);
+		}
+		benchmark::DoNotOptimize(_writer.data());
+	}
+}
+BENCHMARK_TEMPLATE(encode_optional_args, false)->Name("encode_optional_argv");
+BENCHMARK_TEMPLATE(encode_optional_args, true)->Name("encode_optional_args");
+
+#ifndef _WIN32
+//redis_append_commandֻ׷ӵ
+//ӵһǱ̵socketpair,д,дʱ䲻
+class sink_context
+{
+protected:
+	int peer;
+public:
+	context_ptr context;
+
+	sink_context() :peer(-1), context(nullptr, redisFree)
+	{
+		int _fds[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, _fds) == 0) {
+			fcntl(_fds[0], F_SETFL, O_NONBLOCK);
+			fcntl(_fds[1], F_SETFL, O_NONBLOCK);
+			peer = _fds[1];
+			context.reset(redisConnectFd(_fds[0]));
+		}
+	}
+	~sink_context()
+	{
+		context.reset();
+		if (peer >= 0) {
+			close(peer);
+		}
+	}
+
+	void drain()
+	{
+		char _buf[65536];
+		int _done = 0;
+		while (!_done && redisBufferWrite(context.get(), &_done) == REDIS_OK) {
+			while (read(peer, _buf, sizeof(_buf)) > 0) {
+			}
+		}
+	}
+};
+
+template<bool ARGV>
+static void append_command(benchmark::State& _state)
+{
+	sink_context _sink;
+	if (_sink.context == nullptr || _sink.context->err != 0) {
+		_state.SkipWithError("socketpair failed");
+		return;
+	}
+	std::string _key = "bench:hash:0001";
+	std::vector<std::string> _argv = { _key, "field", "123456789", "3.25" };
+	size_t n = 0;
+	alloc_counter _counter(_state);
+	for (auto _ : _state) {
+		if (ARGV) {
+			benchmark::DoNotOptimize(redis_append_command(_sink.context.get(), "HSET", _argv));
+		}
+		else {
+			benchmark::DoNotOptimize(redis_append_command(_sink.context.get(), "HSET", _key, "field", 123456789, 3.25));
+		}
+		if (++n % 1024 == 0) {
+			_state.PauseTiming();
+			_sink.drain();
+			_state.ResumeTiming();
+		}
+	}
+}
+BENCHMARK_TEMPLATE(append_command, false)->Name("append_command_variadic");
+BENCHMARK_TEMPLATE(append_command, true)->Name("append_command_argv");
+#endif
+
+//ͳƵĿ,رʱӦѭͬ
+template<bool ENABLED>
+static void metrics_scope(benchmark::State& _state)
+{
+	synthetic_reply _tree(synthetic_reply::integer(1));
+	redisReply* _raw = _tree.reply();
+	std::string _cmd = "INCR";
+	redis_metrics::enable(ENABLED);
+	alloc_counter _counter(_state);
+	for (auto _ : _state) {
+		redis_metrics::scope _metrics(_cmd);
+		_metrics.done(32, _raw);
+	}
+	redis_metrics::enable(false);
+}
+BENCHMARK_TEMPLATE(metrics_scope, false)->Name("metrics_scope_disabled");
+BENCHMARK_TEMPLATE(metrics_scope, true)->Name("metrics_scope_enabled");
+
+//Ӧת,Ԫ101M
+#define REDIS_BENCH_SIZES RangeMultiplier(10)->Range(10, 1000000)->Unit(benchmark::kMicrosecond)
+
+template<typename T>
+static void decode_vector(benchmark::State& _state)
+{
+	size_t n = (size_t)_state.range(0);
+	//ַԪΪӦ,redis_valueıʽ
+	synthetic_reply _tree(std::is_same<T, std::string>::value ? synthetic_reply::strings(n) : synthetic_reply::integers(n));
+	redis_reply _reply = _tree.reply();
+	alloc_counter _counter(_state);
+	for (auto _ : _state) {
+		std::vector<T> _values = (std::vector<T>)_reply;
+		benchmark::DoNotOptimize(_values.data());
+	}
+	_state.SetItemsProcessed(_state.iterations() * (int64_t)n);
+}
+BENCHMARK_TEMPLATE(decode_vector, std::string)->REDIS_BENCH_SIZES;
+BENCHMARK_TEMPLATE(decode_vector, int64_t)->REDIS_BENCH_SIZES;
+BENCHMARK_TEMPLATE(decode_vector, redis_value)->REDIS_BENCH_SIZES;
+
+template<typename T>
+static void decode_map(benchmark::State& _state)
+{
+	size_t n = (size_t)_state.range(0);
+	synthetic_reply _tree(synthetic_reply::flat_pairs(n));
+	redis_reply _reply = _tree.reply();
+	alloc_counter _counter(_state);
+	for (auto _ : _state) {
+		T _map = (T)_reply;
+		benchmark::DoNotOptimize(&_map);
+	}
+	_state.SetItemsProcessed(_state.iterations() * (int64_t)n);
+}
+BENCHMARK_TEMPLATE(decode_map, std::map<std::string, std::string>)->REDIS_BENCH_SIZES;
+BENCHMARK_TEMPLATE(decode_map, std::unordered_map<std::string, std::string>)->REDIS_BENCH_SIZES;
+
+static void decode_pairs(benchmark::State& _state)
+{
+	size_t n = (size_t)_state.range(0);
+	synthetic_reply _tree(synthetic_reply::nested_pairs(n));
+	redis_reply _reply = _tree.reply();
+	alloc_counter _counter(_state);
+	for (auto _ : _state) {
+		auto _pairs = (std::vector<std::pair<std::string, std::string>>)_reply;
+		benchmark::DoNotOptimize(_pairs.data());
+	}
+	_state.SetItemsProcessed(_state.iterations() * (int64_t)n);
+}
+BENCHMARK(decode_pairs)->REDIS_BENCH_SIZES;
+
+//˵
+template<bool ARGV>
+static void e2e_reply(benchmark::State& _state)
+{
+	context_ptr _context = bench_server::instance().connect(_state);
+	if (_context == nullptr) {
+		return;
+	}
+	std::string _key = "bench:hash:0001";
+	std::vector<std::string> _argv = { _key, "field", "123456789", "3.25" };
+	alloc_counter _counter(_state);
+	for (auto _ : _state) {
+		if (ARGV) {
+			redis_reply _reply(_context.get(), "HSET", _argv);
+			benchmark::DoNotOptimize((redisReply*)_reply);
+		}
+		else {
+			redis_reply _reply(_context.get(), "HSET", _key, "field", 123456789, 3.25);
+			benchmark::DoNotOptimize((redisReply*)_reply);
+		}
+	}
+}
+BENCHMARK_TEMPLATE(e2e_reply, false)->Name("e2e_reply_variadic");
+BENCHMARK_TEMPLATE(e2e_reply, true)->Name("e2e_reply_argv");
+
+static void e2e_SET(benchmark::State& _state)
+{
+	context_ptr _context = bench_server::instance().connect(_state);
+	if (_context == nullptr) {
+		return;
+	}
+	redis_context _redis(_context.get());
+	std::string _value(64, 'v');
+	alloc_counter _counter(_state);
+	for (auto _ : _state) {
+		benchmark::DoNotOptimize(_redis.string().SET("bench:string", _value));
+	}
+}
+BENCHMARK(e2e_SET);
+
+static void e2e_GET(benchmark::State& _state)
+{
+	context_ptr _context = bench_server::instance().connect(_state);
+	if (_context == nullptr) {
+		return;
+	}
+	redis_context _redis(_context.get());
+	_redis.string().SET("bench:string", std::string(64, 'v'));
+	alloc_counter _counter(_state);
+	for (auto _ : _state) {
+		auto _value = _redis.string().GET("bench:string");
+		benchmark::DoNotOptimize(&_value);
+	}
+}
+BENCHMARK(e2e_GET);
+
+static void e2e_HGETALL(benchmark::State& _state)
+{
+	context_ptr _context = bench_server::instance().connect(_state);
+	if (_context == nullptr) {
+		return;
+	}
+	size_t n = (size_t)_state.range(0);
+	redis_context _redis(_context.get());
+	std::map<std::string, std::string> _fields;
+	for (size_t i = 0; i < n; i++) {
+		_fields["field:" + std::to_string(i)] = "value:" + std::to_string(i) + ":0123456789abcdef";
+	}
+	_redis.key().DEL({ "bench:hash" });
+	_redis.hash().HMSET("bench:hash", _fields);
+	alloc_counter _counter(_state);
+	for (auto _ : _state) {
+		auto _values = _redis.hash().HGETALL("bench:hash");
+		benchmark::DoNotOptimize(&_values);
+	}
+	_state.SetItemsProcessed(_state.iterations() * (int64_t)n);
+}
+BENCHMARK(e2e_HGETALL)->RangeMultiplier(10)->Range(10, 10000);
+
+//N,һ
+static void e2e_transaction_exec(benchmark::State& _state)
+{
+	context_ptr _context = bench_server::instance().connect(_state);
+	if (_context == nullptr) {
+		return;
+	}
+	size_t n = (size_t)_state.range(0);
+	std::vector<std::string> _keys;
+	for (size_t i = 0; i < n; i++) {
+		_keys.push_back("bench:tx:" + std::to_string(i));
+	}
+	alloc_counter _counter(_state);
+	for (auto _ : _state) {
+		redis_transaction _trans(_context.get());
+		for (size_t i = 0; i < n; i++) {
+			_trans.append_command("SET", _keys[i], (int64_t)i);
+		}
+		redis_reply _reply = _trans.exec();
+		benchmark::DoNotOptimize((redisReply*)_reply);
+	}
+	_state.SetItemsProcessed(_state.iterations() * (int64_t)n);
+}
+BENCHMARK(e2e_transaction_exec)->RangeMultiplier(10)->Range(1, 1000);
+
+int main(int argc, char** argv)
+{
+#if defined(HIREDIS_MAJOR) && HIREDIS_MAJOR >= 1
+	hiredisSetAllocators(&g_hiredis_allocs);
+#endif
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+		return 1;
+	}
+	benchmark::RunSpecifiedBenchmarks();
+	return 0;
+}
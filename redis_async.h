@@ -0,0 +1,536 @@
+#pragma once
+
+#ifndef __REDIS_ASYNC_H__
+#define __REDIS_ASYNC_H__
+
+#ifdef TC_REDIS
+namespace TC_REDIS {
+#endif
+
+//첽ĻӦ״̬
+//¼ѭ߳,õȴעĺ
+template<typename T>
+class redis_async_state : public redis_future_state<T>
+{
+protected:
+	std::function<void()> continuation;
+public:
+	//ӦѾʱִ,ڻӦʱִ
+	void on_ready(std::function<void()> _continuation)
+	{
+		if (this->ready) {
+			_continuation();
+		}
+		else {
+			continuation = std::move(_continuation);
+		}
+	}
+
+	void complete()
+	{
+		std::function<void()> _continuation;
+		_continuation.swap(continuation);
+		if (_continuation) {
+			_continuation();
+		}
+	}
+};
+
+//ת첽Ӧ״̬
+template<typename CONVERT>
+class redis_async_task : public redis_async_state<typename CONVERT::result_type>
+{
+protected:
+	CONVERT convert;
+public:
+	redis_async_task(const CONVERT& _convert) :convert(_convert) {}
+
+	virtual void resolve(const redis_reply& _reply)
+	{
+		try {
+			this->value = convert(_reply);
+			this->ready = true;
+		}
+		catch (...) {
+			this->reject(std::current_exception());
+		}
+	}
+};
+
+//첽Ľ
+//then()עص,C++20Ҳco_await,Ĵget()co_awaitʱ׳
+//صЭ̵Ļָ¼ѭ߳
+template<typename T>
+class redis_async_result
+{
+protected:
+	std::shared_ptr<redis_async_state<T>> state;
+public:
+	redis_async_result() {}
+	redis_async_result(const std::shared_ptr<redis_async_state<T>>& _state) :state(_state) {}
+
+	bool valid()const { return state != nullptr; }
+	bool ready()const { return state && state->is_ready(); }
+
+	T& get()
+	{
+		redis_test(valid(), redis_error_code::reply_not_ready);
+		return state->get();
+	}
+
+	//Ӧغ_callback(result),ڻصget()ȡֵ򲶻
+	//ص׳쳣
+	void then(std::function<void(redis_async_result<T>&)> _callback)
+	{
+		redis_test(valid(), redis_error_code::reply_not_ready);
+		redis_async_result<T> _self(*this);
+		state->on_ready([_self, _callback]() mutable { _callback(_self); });
+	}
+
+#ifdef REDIS_HAS_COROUTINE
+	bool await_ready()const { return ready(); }
+	void await_suspend(std::coroutine_handle<> _handle) {
+		state->on_ready([_handle]() { _handle.resume(); });
+	}
+	T await_resume() { return std::move(get()); }
+#endif
+};
+
+#ifdef REDIS_HAS_COROUTINE
+//ȴЭ,¼ѭһco_await
+//Эδ쳣ֹ,std::threadһ
+class redis_async_detached
+{
+public:
+	struct promise_type {
+		redis_async_detached get_return_object() { return redis_async_detached(); }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+#endif
+
+class redis_async_context;
+
+//첽,д첽Ӻredis_async_result
+class redis_async_driver
+{
+protected:
+	redis_async_context* context;
+public:
+	template<typename T> using result = redis_async_result<T>;
+
+	redis_async_driver(redis_async_context* _context) :context(_context) {
+	}
+
+	template<typename CONVERT, typename... ARGS>
+	redis_async_result<typename CONVERT::result_type> command(const CONVERT& _convert, const std::string& _cmd, ARGS&&... _args);
+};
+
+//redis첽
+//redisAsyncContext,ṩredis_contextͬӿ,redis_async_result
+//Ҫҵһ¼ѭ(Linux¿ʹredis_async_loop,ƽ̨ʹhiredisԴadapters)
+//hiredis첽Ӳ̰߳ȫ,¼ѭ߳з
+class redis_async_context
+{
+protected:
+	struct pending_command {
+		std::string cmd;
+		std::shared_ptr<redis_future_state_base> state;
+		std::function<void()> complete;
+	};
+
+	redisAsyncContext* context;
+
+	//hiredisڻصغͷŻӦ,Ӧredis_reply
+	static void on_reply(redisAsyncContext* _context, void* _reply, void* _privdata)
+	{
+		std::unique_ptr<pending_command> _pending((pending_command*)_privdata);
+		redis_reply _redis_reply((redisReply*)_reply, _pending->cmd);
+		if (_reply == nullptr) {
+			std::string _describe = (_context != nullptr && _context->errstr != nullptr) ? _context->errstr : "";
+			_pending->state->reject(std::make_exception_ptr(
+				redis_error(redis_error_code::command_error, _describe, _pending->cmd)));
+		}
+		else {
+			_pending->state->resolve(_redis_reply);
+		}
+		_pending->complete();
+	}
+
+	//ʧܻϿhiredisͷredisAsyncContext
+	static void on_connect(const redisAsyncContext* _context, int _status)
+	{
+		if (_status != REDIS_OK && _context->data != nullptr) {
+			((redis_async_context*)_context->data)->context = nullptr;
+		}
+	}
+	static void on_disconnect(const redisAsyncContext* _context, int)
+	{
+		if (_context->data != nullptr) {
+			((redis_async_context*)_context->data)->context = nullptr;
+		}
+	}
+
+	void attach(redisAsyncContext* _context)
+	{
+		if (_context != nullptr && _context->err) {
+			std::string _describe = _context->errstr;
+			redisAsyncFree(_context);
+			throw redis_error(redis_error_code::command_error, _describe, "CONNECT");
+		}
+		redis_test(_context != nullptr, redis_error_code::command_error, "CONNECT");
+
+		context = _context;
+		context->data = this;
+		context->c.flags |= REDIS_NO_AUTO_FREE_REPLIES;
+		redisAsyncSetConnectCallback(context, on_connect);
+		redisAsyncSetDisconnectCallback(context, on_disconnect);
+	}
+
+	redis_async_context(const redis_async_context&) = delete;
+	redis_async_context& operator =(const redis_async_context&) = delete;
+public:
+	//ӹѴ첽,_contextϲ/Ͽص
+	redis_async_context(redisAsyncContext* _context) :
+		context(nullptr)
+	{
+		attach(_context);
+	}
+	redis_async_context(const std::string& _host, int _port) :
+		context(nullptr)
+	{
+		attach(redisAsyncConnect(_host.c_str(), _port));
+	}
+	//δصȫԴ
+	~redis_async_context()
+	{
+		if (context != nullptr) {
+			context->data = nullptr;
+			redisAsyncFree(context);
+		}
+	}
+
+	//ײhiredis첽,ӶϿΪnullptr
+	redisAsyncContext* get()const { return context; }
+	bool connected()const { return context != nullptr; }
+
+	//Ͽ,ѷغٹر
+	void disconnect()
+	{
+		if (context != nullptr) {
+			redisAsyncDisconnect(context);
+		}
+	}
+
+	//ʹòݷ
+	//_convertѻӦתɽ
+	template<typename CONVERT, typename... ARGS>
+	redis_async_result<typename CONVERT::result_type> append(const CONVERT& _convert, const std::string& _cmd, ARGS&&... _args)
+	{
+		redis_test(context != nullptr, redis_error_code::command_error, _cmd);
+
+		auto _state = std::make_shared<redis_async_task<CONVERT>>(_convert);
+		std::unique_ptr<pending_command> _pending(new pending_command());
+		_pending->state = _state;
+		_pending->complete = [_state]() { _state->complete(); };
+
+		redis_command_writer _writer;
+		_writer.command(_cmd, _args...);
+		int ret = redisAsyncFormattedCommand(context, on_reply, _pending.get(), _writer.data(), _writer.size());
+		_pending->cmd = redis_command_capture::need_render(ret != REDIS_OK) ?
+			redis_command_render(_cmd, _args...) : _cmd;
+		redis_test(ret == REDIS_OK, redis_error_code::command_error, _pending->cmd);
+		_pending.release();
+
+		return redis_async_result<typename CONVERT::result_type>(_state);
+	}
+
+	redis_key<redis_async_driver> key() {
+		return redis_key<redis_async_driver>(this);
+	}
+	redis_string<redis_async_driver> string() {
+		return redis_string<redis_async_driver>(this);
+	}
+	redis_hash<redis_async_driver> hash() {
+		return redis_hash<redis_async_driver>(this);
+	}
+	redis_list<redis_async_driver> list() {
+		return redis_list<redis_async_driver>(this);
+	}
+	redis_set<redis_async_driver> set() {
+		return redis_set<redis_async_driver>(this);
+	}
+	redis_sortedset<redis_async_driver> sortedset() {
+		return redis_sortedset<redis_async_driver>(this);
+	}
+	redis_stream<redis_async_driver> stream() {
+		return redis_stream<redis_async_driver>(this);
+	}
+};
+
+template<typename CONVERT, typename... ARGS>
+redis_async_result<typename CONVERT::result_type> redis_async_driver::command(const CONVERT& _convert, const std::string& _cmd, ARGS&&... _args) {
+	return context->append(_convert, _cmd, std::forward<ARGS>(_args)...);
+}
+
+#ifdef __linux__
+//epoll¼ѭ
+//ʵhiredis¼ҹ,һ߳̿첽Ӽ;
+//post()stop(),нӿڶֻrun()߳е
+class redis_async_loop
+{
+protected:
+	struct event {
+		redis_async_loop* loop;
+		redisAsyncContext* context;
+		uint64_t id;
+		int fd;
+		uint32_t events;
+		bool timer;
+		std::chrono::steady_clock::time_point deadline;
+	};
+
+	int epoll_fd;
+	int wake_fd;
+	uint64_t next_id;
+	std::unordered_map<uint64_t, event*> events;
+
+	std::mutex mutex;
+	std::vector<std::function<void()>> tasks;
+	std::atomic<bool> stopped;
+
+	void update(event* _event, uint32_t _events)
+	{
+		if (_event->events == _events) {
+			return;
+		}
+		struct epoll_event _ev;
+		memset(&_ev, 0, sizeof(_ev));
+		_ev.events = _events;
+		_ev.data.u64 = _event->id;
+		int _op = _event->events == 0 ? EPOLL_CTL_ADD : (_events == 0 ? EPOLL_CTL_DEL : EPOLL_CTL_MOD);
+		epoll_ctl(epoll_fd, _op, _event->fd, &_ev);
+		_event->events = _events;
+	}
+
+	static void add_read(void* _privdata) {
+		event* _event = (event*)_privdata;
+		_event->loop->update(_event, _event->events | EPOLLIN);
+	}
+	static void del_read(void* _privdata) {
+		event* _event = (event*)_privdata;
+		_event->loop->update(_event, _event->events & ~(uint32_t)EPOLLIN);
+	}
+	static void add_write(void* _privdata) {
+		event* _event = (event*)_privdata;
+		_event->loop->update(_event, _event->events | EPOLLOUT);
+	}
+	static void del_write(void* _privdata) {
+		event* _event = (event*)_privdata;
+		_event->loop->update(_event, _event->events & ~(uint32_t)EPOLLOUT);
+	}
+	static void schedule_timer(void* _privdata, struct timeval _tv) {
+		event* _event = (event*)_privdata;
+		_event->timer = true;
+		_event->deadline = std::chrono::steady_clock::now()
+			+ std::chrono::seconds(_tv.tv_sec) + std::chrono::microseconds(_tv.tv_usec);
+	}
+	static void cleanup(void* _privdata) {
+		event* _event = (event*)_privdata;
+		_event->loop->update(_event, 0);
+		_event->loop->events.erase(_event->id);
+		delete _event;
+	}
+
+	//ĳʱжٺ,ûгʱ_timeout_ms
+	int next_timeout(int _timeout_ms)const
+	{
+		auto _now = std::chrono::steady_clock::now();
+		for (auto& _item : events) {
+			if (_item.second->timer) {
+				auto _left = std::chrono::duration_cast<std::chrono::milliseconds>(_item.second->deadline - _now).count();
+				_left = _left < 0 ? 0 : _left + 1;
+				if (_timeout_ms < 0 || _left < _timeout_ms) {
+					_timeout_ms = (int)_left;
+				}
+			}
+		}
+		return _timeout_ms;
+	}
+
+	void handle_timers()
+	{
+		auto _now = std::chrono::steady_clock::now();
+		std::vector<uint64_t> _expired;
+		for (auto& _item : events) {
+			if (_item.second->timer && _item.second->deadline <= _now) {
+				_expired.push_back(_item.first);
+			}
+		}
+		for (auto _id : _expired) {
+			auto it = events.find(_id);
+			if (it != events.end()) {
+				it->second->timer = false;
+				redisAsyncHandleTimeout(it->second->context);
+			}
+		}
+	}
+
+	void run_tasks()
+	{
+		uint64_t _count = 0;
+		if (read(wake_fd, &_count, sizeof(_count)) < 0) {
+			//eventfdΪ,û֪ͨʱֱӷ
+		}
+		std::vector<std::function<void()>> _tasks;
+		{
+			std::lock_guard<std::mutex> _lock(mutex);
+			_tasks.swap(tasks);
+		}
+		for (auto& _task : _tasks) {
+			_task();
+		}
+	}
+
+	void wake()
+	{
+		uint64_t _one = 1;
+		if (write(wake_fd, &_one, sizeof(_one)) < 0) {
+			//ʱѭȻᱻ
+		}
+	}
+
+	redis_async_loop(const redis_async_loop&) = delete;
+	redis_async_loop& operator =(const redis_async_loop&) = delete;
+public:
+	redis_async_loop() :
+		epoll_fd(epoll_create1(EPOLL_CLOEXEC)), wake_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+		next_id(1), stopped(false)
+	{
+		redis_test(epoll_fd >= 0 && wake_fd >= 0);
+		struct epoll_event _ev;
+		memset(&_ev, 0, sizeof(_ev));
+		_ev.events = EPOLLIN;
+		_ev.data.u64 = 0;
+		epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &_ev);
+	}
+	//ѭϵӱѭ
+	~redis_async_loop()
+	{
+		close(wake_fd);
+		close(epoll_fd);
+	}
+
+	//첽ӹҵѭ
+	void attach(redisAsyncContext* _context)
+	{
+		redis_test(_context != nullptr && _context->ev.data == nullptr);
+
+		event* _event = new event();
+		_event->loop = this;
+		_event->context = _context;
+		_event->id = next_id++;
+		_event->fd = _context->c.fd;
+		_event->events = 0;
+		_event->timer = false;
+		events[_event->id] = _event;
+
+		_context->ev.addRead = add_read;
+		_context->ev.delRead = del_read;
+		_context->ev.addWrite = add_write;
+		_context->ev.delWrite = del_write;
+		_context->ev.cleanup = cleanup;
+		_context->ev.scheduleTimer = schedule_timer;
+		_context->ev.data = _event;
+	}
+	void attach(redis_async_context& _context) {
+		attach(_context.get());
+	}
+
+	//̰߳ȫ,_taskѭִ߳,̷߳
+	void post(std::function<void()> _task)
+	{
+		{
+			std::lock_guard<std::mutex> _lock(mutex);
+			tasks.push_back(std::move(_task));
+		}
+		wake();
+	}
+
+	//һ¼,ȴ_timeout_ms,-1ʾһֱȴ
+	void run_once(int _timeout_ms = -1)
+	{
+		struct epoll_event _evs[64];
+		int n = epoll_wait(epoll_fd, _evs, 64, next_timeout(_timeout_ms));
+		for (int i = 0; i < n; i++) {
+			if (_evs[i].data.u64 == 0) {
+				run_tasks();
+				continue;
+			}
+			//ǰĻصѾͷ
+			auto it = events.find(_evs[i].data.u64);
+			if (it != events.end() && (_evs[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))) {
+				redisAsyncHandleRead(it->second->context);
+			}
+			it = events.find(_evs[i].data.u64);
+			if (it != events.end() && (_evs[i].events & EPOLLOUT)) {
+				redisAsyncHandleWrite(it->second->context);
+			}
+		}
+		handle_timers();
+	}
+
+	//һֱеstop()
+	void run()
+	{
+		stopped = false;
+		while (!stopped) {
+			run_once();
+		}
+	}
+
+	//̰߳ȫ
+	void stop()
+	{
+		stopped = true;
+		wake();
+	}
+};
+#endif
+
+/*
+	һ򵥵
+
+	redis_async_loop _loop;
+	redis_async_context _context("127.0.0.1", 6379);
+	_loop.attach(_context);
+
+	//ص
+	_context.string().GET(_key).then([](redis_async_result<redis_optional<std::string>>& _result) {
+		try {
+			auto& _value = _result.get();
+			...
+		}
+		catch (const redis_error& e) {
+			...
+		}
+	});
+
+	//C++20Э
+	redis_async_detached _task(redis_async_context& _context) {
+		int64_t count = co_await _context.string().INCR(_key);
+		auto value = co_await _context.string().GET(_key2);
+		...
+	}
+
+	_loop.run();
+*/
+
+#ifdef TC_REDIS
+}
+#endif
+
+#endif
@@ -0,0 +1,411 @@
+#pragma once
+
+#ifndef __REDIS_CACHE_H__
+#define __REDIS_CACHE_H__
+
+#ifdef TC_REDIS
+namespace TC_REDIS {
+#endif
+
+//˻,GETHGETĽ
+//ȡʱͨCLIENT TRACKING REDIRECT÷ס̶key,key޸ʱʧЧʧЧϢ
+//ʧЧӶϿڼϢ޷,Ͽʱ
+//水keyƬ,ÿƬһһLRU,Ŀ(һַkeyһhashֶһ)
+//ͬʱοPTTL,keyں
+//ʧЧӵĶȡ߳pollͬʱȴsocket¼,ʱͣ
+#ifdef __linux__
+class redis_near_cache
+{
+protected:
+	struct entry {
+		redis_optional<std::string> value;	//GETĽ
+		std::unordered_map<std::string, redis_optional<std::string>> fields;	//HGETĽ
+		bool has_value;
+		std::chrono::steady_clock::time_point expire;	//time_point::max()ʾ
+		std::list<std::string>::iterator lru;
+	};
+
+	struct shard {
+		std::mutex mutex;
+		std::unordered_map<std::string, entry> entries;
+		std::list<std::string> lru;		//ͷʹ
+		size_t size;					//Ŀ
+		uint64_t invalidations;			//ʧЧ,ȡڼ䷢ʧЧʱд뻺
+
+		shard() :size(0), invalidations(0) {}
+	};
+
+	std::function<redisContext*()> connect;
+	std::unique_ptr<shard[]> shards;
+	size_t shard_count;
+	size_t shard_capacity;
+	std::chrono::milliseconds max_ttl;
+
+	//ȡõ,ÿǰȷѿTRACKINGض򵽵ǰʧЧ
+	redis_pool pool;
+	std::mutex track_mutex;
+	std::unordered_map<redisContext*, uint64_t> tracked;	//ӿTRACKINGʱʧЧӵĴ
+	uint64_t generation;		//ʧЧÿһ
+	int64_t redirect_id;		//ʧЧӵCLIENT ID,-1ʾ
+
+	redis_reconnect_loop loop;
+	std::thread listener;
+
+	std::atomic<uint64_t> hits;
+	std::atomic<uint64_t> misses;
+
+	static constexpr const char* channel() { return "__redis__:invalidate"; }
+
+	shard& get_shard(const std::string& _key) {
+		return shards[std::hash<std::string>()(_key) % shard_count];
+	}
+
+	static std::chrono::steady_clock::time_point now() {
+		return std::chrono::steady_clock::now();
+	}
+
+	void erase(shard& _shard, std::unordered_map<std::string, entry>::iterator _it)
+	{
+		_shard.size -= _it->second.has_value ? 1 : 0;
+		_shard.size -= _it->second.fields.size();
+		_shard.lru.erase(_it->second.lru);
+		_shard.entries.erase(_it);
+	}
+
+	//δڵĿƵLRUͷ,÷зƬ
+	entry* find(shard& _shard, const std::string& _key)
+	{
+		auto _it = _shard.entries.find(_key);
+		if (_it == _shard.entries.end()) {
+			return nullptr;
+		}
+		if (_it->second.expire <= now()) {
+			erase(_shard, _it);
+			return nullptr;
+		}
+		_shard.lru.splice(_shard.lru.begin(), _shard.lru, _it->second.lru);
+		return &_it->second;
+	}
+
+	//ȡû½Ŀ,÷зƬ
+	entry& obtain(shard& _shard, const std::string& _key, std::chrono::steady_clock::time_point _expire)
+	{
+		auto _it = _shard.entries.find(_key);
+		if (_it == _shard.entries.end()) {
+			_shard.lru.push_front(_key);
+			_it = _shard.entries.emplace(_key, entry()).first;
+			_it->second.has_value = false;
+			_it->second.lru = _shard.lru.begin();
+		}
+		else {
+			_shard.lru.splice(_shard.lru.begin(), _shard.lru, _it->second.lru);
+		}
+		_it->second.expire = _expire;
+		return _it->second;
+	}
+
+	//ʱLRUβ̭,дkey
+	void evict(shard& _shard)
+	{
+		while (_shard.size > shard_capacity && _shard.lru.size() > 1) {
+			erase(_shard, _shard.entries.find(_shard.lru.back()));
+		}
+	}
+
+	//PTTLʱ,-2ʾkey,ûйڴ(keyʱյʧЧϢ)
+	std::chrono::steady_clock::time_point expire_at(int64_t _pttl)
+	{
+		auto _expire = std::chrono::steady_clock::time_point::max();
+		if (_pttl >= 0) {
+			_expire = now() + std::chrono::milliseconds(_pttl);
+		}
+		if (max_ttl.count() > 0) {
+			_expire = std::min(_expire, now() + max_ttl);
+		}
+		return _expire;
+	}
+
+	//ȷѿTRACKINGض򵽵ǰʧЧ,ʧЧӲʱfalse
+	bool ensure_tracked(redisContext* _context)
+	{
+		std::lock_guard<std::mutex> _lock(track_mutex);
+		if (redirect_id < 0) {
+			return false;
+		}
+		auto _it = tracked.find(_context);
+		if (_it != tracked.end() && _it->second == generation) {
+			return true;
+		}
+		redis_reply _reply(_context, "CLIENT", "TRACKING", "on", "REDIRECT", redirect_id);
+		redisReply* _tracking = _reply;
+		if (_tracking == nullptr || _tracking->type == REDIS_REPLY_ERROR) {
+			return false;
+		}
+		tracked[_context] = generation;
+		return true;
+	}
+
+	//ӳشӿܸͷӵĵַ,¼
+	redisContext* create_context()
+	{
+		redisContext* _context = connect();
+		if (_context != nullptr) {
+			std::lock_guard<std::mutex> _lock(track_mutex);
+			tracked.erase(_context);
+		}
+		return _context;
+	}
+
+	void invalidate_all()
+	{
+		for (size_t i = 0; i < shard_count; i++) {
+			std::lock_guard<std::mutex> _lock(shards[i].mutex);
+			shards[i].entries.clear();
+			shards[i].lru.clear();
+			shards[i].size = 0;
+			shards[i].invalidations++;
+		}
+	}
+
+	//ʧЧӵĶȡ߳,Ͽջ沢
+	void listen()
+	{
+		loop.run(connect, [this](redisContext* _context) { serve(_context); }, [this]() {
+			{
+				std::lock_guard<std::mutex> _lock(track_mutex);
+				redirect_id = -1;
+			}
+			invalidate_all();
+		});
+	}
+
+	//ʧЧƵϢ,ֱӳֹͣ
+	void serve(redisContext* _context)
+	{
+		int64_t _id = (int64_t)redis_reply(_context, "CLIENT", "ID");
+		redis_reply _subscribe(_context, "SUBSCRIBE", channel());
+		redisReply* _subscribed = _subscribe;
+		redis_test(_subscribed != nullptr && _subscribed->type == REDIS_REPLY_ARRAY, redis_error_code::command_error, "SUBSCRIBE");
+
+		//֮ǰȡkeyʧЧ֪ͨ
+		invalidate_all();
+		{
+			std::lock_guard<std::mutex> _lock(track_mutex);
+			redirect_id = _id;
+			generation++;
+		}
+
+		while (!loop.stopped())
+		{
+			//ȴѾ뻺Ϣ
+			for (;;) {
+				redisReply* _message = nullptr;
+				redis_test(redisGetReplyFromReader(_context, (void**)&_message) == REDIS_OK,
+					redis_error_code::command_error, "SUBSCRIBE");
+				if (_message == nullptr) {
+					break;
+				}
+				invalidate(_message);
+				redis_reply_arena::free_reply(_context, _message);
+			}
+
+			bool _woken = false;
+			if (loop.wait(_context->fd, _woken)) {
+				redis_test(redisBufferRead(_context) == REDIS_OK, redis_error_code::command_error, "SUBSCRIBE");
+			}
+		}
+	}
+
+	redis_near_cache(const redis_near_cache&) = delete;
+	redis_near_cache& operator =(const redis_near_cache&) = delete;
+public:
+	//_connect𴴽һõ(AUTH,SELECT),ڶȡʧЧϢ
+	//_capacityΪ໺Ŀ,ƽֵ_shardsƬ
+	//_connectionsΪȡδʱʹõ
+	//_max_ttlΪĿʱ,ʧЧϢʧʱôõľֵ,0ʾֻʧЧϢPTTL
+	redis_near_cache(std::function<redisContext*()> _connect, size_t _capacity = 100000, size_t _shards = 16,
+		size_t _connections = 4, std::chrono::milliseconds _max_ttl = std::chrono::milliseconds(0)) :
+		connect(_connect), shards(new shard[_shards]), shard_count(_shards),
+		shard_capacity(std::max<size_t>(1, _capacity / std::max<size_t>(1, _shards))), max_ttl(_max_ttl),
+		pool([this]() { return create_context(); }, _connections),
+		generation(0), redirect_id(-1), hits(0), misses(0)
+	{
+		redis_test(_shards > 0 && _connections > 0);
+		listener = std::thread([this]() { listen(); });
+	}
+
+	redis_near_cache(const std::string& _host, int _port, size_t _capacity = 100000, size_t _shards = 16,
+		size_t _connections = 4, std::chrono::milliseconds _max_ttl = std::chrono::milliseconds(0)) :
+		redis_near_cache(redis_connector(_host, _port), _capacity, _shards, _connections, _max_ttl)
+	{
+	}
+
+	~redis_near_cache()
+	{
+		loop.stop();
+		listener.join();
+	}
+
+	//ʧЧǷ,ʱȡֱӷʷ
+	bool tracking()
+	{
+		std::lock_guard<std::mutex> _lock(track_mutex);
+		return redirect_id >= 0;
+	}
+
+	redis_optional<std::string> GET(const std::string& key)
+	{
+		shard& _shard = get_shard(key);
+		uint64_t _invalidations = 0;
+		{
+			std::lock_guard<std::mutex> _lock(_shard.mutex);
+			entry* _entry = find(_shard, key);
+			if (_entry != nullptr && _entry->has_value) {
+				hits++;
+				return _entry->value;
+			}
+			_invalidations = _shard.invalidations;
+		}
+		misses++;
+
+		auto _lease = pool.acquire();
+		bool _tracked = ensure_tracked(_lease.get());
+		redis_pipeline _pipeline(_lease.get());
+		auto _value = _pipeline.string().GET(key);
+		auto _pttl = _pipeline.key().PTTL(key);
+		_pipeline.flush();
+
+		redis_optional<std::string> _result = std::move(_value.get());
+		if (_tracked) {
+			std::lock_guard<std::mutex> _lock(_shard.mutex);
+			if (_shard.invalidations == _invalidations) {
+				entry& _entry = obtain(_shard, key, expire_at(_pttl.get()));
+				_shard.size += _entry.has_value ? 0 : 1;
+				_entry.value = _result;
+				_entry.has_value = true;
+				evict(_shard);
+			}
+		}
+		return _result;
+	}
+
+	redis_optional<std::string> HGET(const std::string& key, const std::string& field)
+	{
+		shard& _shard = get_shard(key);
+		uint64_t _invalidations = 0;
+		{
+			std::lock_guard<std::mutex> _lock(_shard.mutex);
+			entry* _entry = find(_shard, key);
+			if (_entry != nullptr) {
+				auto _it = _entry->fields.find(field);
+				if (_it != _entry->fields.end()) {
+					hits++;
+					return _it->second;
+				}
+			}
+			_invalidations = _shard.invalidations;
+		}
+		misses++;
+
+		auto _lease = pool.acquire();
+		bool _tracked = ensure_tracked(_lease.get());
+		redis_pipeline _pipeline(_lease.get());
+		auto _value = _pipeline.hash().HGET(key, field);
+		auto _pttl = _pipeline.key().PTTL(key);
+		_pipeline.flush();
+
+		redis_optional<std::string> _result = std::move(_value.get());
+		if (_tracked) {
+			std::lock_guard<std::mutex> _lock(_shard.mutex);
+			if (_shard.invalidations == _invalidations) {
+				entry& _entry = obtain(_shard, key, expire_at(_pttl.get()));
+				_shard.size += _entry.fields.emplace(field, _result).second ? 1 : 0;
+				evict(_shard);
+			}
+		}
+		return _result;
+	}
+
+	//ʹػkeyʧЧ
+	void invalidate(const std::string& key)
+	{
+		shard& _shard = get_shard(key);
+		std::lock_guard<std::mutex> _lock(_shard.mutex);
+		auto _it = _shard.entries.find(key);
+		if (_it != _shard.entries.end()) {
+			erase(_shard, _it);
+		}
+		_shard.invalidations++;
+	}
+
+	//һʧЧϢ
+	//֧RESP2["message", "__redis__:invalidate", keys]RESP3pushϢ["invalidate", keys]
+	//keysΪnilʱ(FLUSHALL/FLUSHDB),Ϣ
+	//ʹRESP3ʱ,Լpushصе
+	void invalidate(const redisReply* _message)
+	{
+		bool _array = _message != nullptr && _message->type == REDIS_REPLY_ARRAY;
+#ifdef REDIS_REPLY_PUSH
+		_array = _array || (_message != nullptr && _message->type == REDIS_REPLY_PUSH);
+#endif
+		if (!_array || _message->elements < 2) {
+			return;
+		}
+		const redisReply* _kind = _message->element[0];
+		const redisReply* _keys = nullptr;
+		if (_message->elements == 3 && _kind->len == 7 && memcmp(_kind->str, "message", 7) == 0) {
+			_keys = _message->element[2];
+		}
+		else if (_message->elements == 2 && _kind->len == 10 && memcmp(_kind->str, "invalidate", 10) == 0) {
+			_keys = _message->element[1];
+		}
+		else {
+			return;
+		}
+
+		if (_keys->type == REDIS_REPLY_NIL) {
+			invalidate_all();
+		}
+		else if (_keys->type == REDIS_REPLY_ARRAY) {
+			for (size_t i = 0; i < _keys->elements; i++) {
+				invalidate(std::string(_keys->element[i]->str, _keys->element[i]->len));
+			}
+		}
+	}
+
+	//ձػ
+	void clear() {
+		invalidate_all();
+	}
+
+	//Ŀ
+	size_t size()
+	{
+		size_t _size = 0;
+		for (size_t i = 0; i < shard_count; i++) {
+			std::lock_guard<std::mutex> _lock(shards[i].mutex);
+			_size += shards[i].size;
+		}
+		return _size;
+	}
+
+	uint64_t hit_count()const { return hits.load(); }
+	uint64_t miss_count()const { return misses.load(); }
+};
+#endif
+
+/*
+	һ򵥵
+
+	redis_near_cache _cache("127.0.0.1", 6379, 100000);
+
+	//߳
+	auto _config = _cache.GET("config:feature");
+	auto _name = _cache.HGET("user:1", "name");
+*/
+
+#ifdef TC_REDIS
+}
+#endif
+
+#endif
@@ -0,0 +1,848 @@
+#pragma once
+
+#ifndef __REDIS_CLUSTER_H__
+#define __REDIS_CLUSTER_H__
+
+#ifdef TC_REDIS
+namespace TC_REDIS {
+#endif
+
+//redis clusterslot
+class redis_cluster_slot
+{
+protected:
+	//CRC16-CCITT(XMODEM)
+	struct crc16_table {
+		uint16_t table[256];
+		crc16_table() {
+			for (int i = 0; i < 256; i++) {
+				uint16_t _crc = (uint16_t)(i << 8);
+				for (int j = 0; j < 8; j++) {
+					_crc = (_crc & 0x8000) ? (uint16_t)((_crc << 1) ^ 0x1021) : (uint16_t)(_crc << 1);
+				}
+				table[i] = _crc;
+			}
+		}
+	};
+public:
+	enum { slot_count = 16384 };
+
+	static uint16_t crc16(const char* buf, size_t len)
+	{
+		static const crc16_table _table;
+		uint16_t _crc = 0;
+		for (size_t i = 0; i < len; i++) {
+			_crc = (uint16_t)((_crc << 8) ^ _table.table[((_crc >> 8) ^ (uint8_t)buf[i]) & 0xff]);
+		}
+		return _crc;
+	}
+
+	//keyзǿյ{hash tag}ʱֻtag
+	static uint16_t get(const char* key, size_t len)
+	{
+		const char* _begin = (const char*)memchr(key, '{', len);
+		if (_begin != nullptr) {
+			const char* _end = (const char*)memchr(_begin + 1, '}', len - (_begin + 1 - key));
+			if (_end != nullptr && _end != _begin + 1) {
+				return crc16(_begin + 1, _end - _begin - 1) & (slot_count - 1);
+			}
+		}
+		return crc16(key, len) & (slot_count - 1);
+	}
+	static uint16_t get(const std::string& key) {
+		return get(key.data(), key.size());
+	}
+};
+
+//ҳindexΪ·õkey
+//std::vector<std::string>䰴Ԫչ
+class redis_cluster_key
+{
+protected:
+	size_t index;
+	const char* marker;		//ΪʱkeyǸò֮ĵһ(XREADSTREAMS)
+public:
+	bool found;
+	std::string key;
+
+	redis_cluster_key(size_t _index, const char* _marker = nullptr) :index(_index), marker(_marker), found(false) {}
+
+	void operator ()(const char* v) { take(v, strlen(v)); }
+	void operator ()(const std::string& v) { take(v.data(), v.size()); }
+	template<size_t N>
+	void operator ()(const char (&v)[N]) { take(v, strlen(v)); }
+	void operator ()(const std::vector<std::string>& argv) {
+		for (auto& _arg : argv) {
+			take(_arg.data(), _arg.size());
+		}
+	}
+#ifdef REDIS_HAS_STRING_VIEW
+	void operator ()(std::string_view v) { take(v.data(), v.size()); }
+#endif
+	template<typename IT>
+	void operator ()(const redis_arg_range<IT>& v) { v.for_each(*this); }
+	template<typename IT>
+	void operator ()(const redis_pair_range<IT>& v) { v.for_each(*this); }
+	void operator ()(const redis_arg_view& v) { take(v.data, v.size); }
+	void operator ()(const redis_command_args& v) { v.for_each(*this); }
+	template<typename T>
+	void operator ()(const T&) { take(nullptr, 0); }
+
+	void take(const char* v, size_t len)
+	{
+		if (marker != nullptr) {
+			if (v != nullptr && len == strlen(marker) && _strnicmp(v, marker, len) == 0) {
+				marker = nullptr;
+				index = 0;
+			}
+			return;
+		}
+		if (!found && index == 0 && v != nullptr) {
+			key.assign(v, len);
+			found = true;
+		}
+		else if (index > 0) {
+			index--;
+		}
+	}
+};
+
+class redis_cluster_context;
+
+//Ⱥ,keyڵslotӦڵ
+class redis_cluster_driver
+{
+protected:
+	redis_cluster_context* cluster;
+public:
+	template<typename T> using result = T;
+
+	redis_cluster_driver(redis_cluster_context* _cluster) :cluster(_cluster) {
+	}
+
+	template<typename CONVERT, typename... ARGS>
+	typename CONVERT::result_type command(const CONVERT& _convert, const std::string& _cmd, ARGS&&... _args);
+
+	//ÿһڵֲз,֮˳ִ
+	template<typename BUILD, typename ON_REPLY>
+	void chunked(const std::string& _cmd, size_t _count, size_t _chunk_size,
+		BUILD _build, ON_REPLY _on_reply, size_t _window = 4);
+};
+
+template<>
+class is_redis_cluster_driver<redis_cluster_driver> {
+public:
+	enum { value = true };
+};
+
+//redisȺ
+//ʱCLUSTER SLOTS16384slot,keyslot(֧{hash tag})Ӧڵ
+//յMOVEDʱslotԺˢű,յASKʱASKINGתһ
+//MGET,DEL,EXISTS,UNLINK,TOUCH,MSETslotɶ,ÿڵһˮ,ȫζȡ,ԭ˳ϲ
+//KEYSÿڵִвϲ,RANDOMKEYڵ㿪ʼҵһǿյkey
+//ûkeySCANڼȺʹ,redis_parallel_scan(scan_sources())
+//redis_contextһ̰߳ȫ
+class redis_cluster_context
+{
+protected:
+	struct node {
+		std::string host;
+		int port;
+		redisContext* context;
+	};
+
+	//ֺͬһslotһkey
+	struct part {
+		uint16_t slot;
+		size_t node;
+		std::vector<size_t> items;
+		std::vector<std::string> argv;
+		std::string cmd;
+		bool sent;
+		redis_reply reply;
+		std::string error;		//ȡӦʧʱĴ
+
+		part() :slot(0), node(0), sent(false), reply(nullptr) {}
+	};
+
+	enum : uint16_t { no_node = 0xffff };
+
+	std::function<redisContext*(const std::string&, int)> connect;
+	std::vector<node> nodes;
+	std::unique_ptr<uint16_t[]> slots;
+	int max_redirects;
+	bool stale;
+	std::chrono::steady_clock::time_point last_refresh;
+	std::chrono::milliseconds refresh_interval;
+
+	enum { no_key = -1, after_streams = -2 };
+
+	//ĵһkeyڲеλ,no_keyʾûkey,after_streamsʾSTREAMS֮ĵһ
+	static int key_index(const std::string& _cmd)
+	{
+		static const std::map<std::string, int> _index = {
+			{ "BITOP", 1 }, { "OBJECT", 1 }, { "MIGRATE", 2 }, { "EVAL", 2 }, { "EVALSHA", 2 },
+			{ "XGROUP", 1 }, { "XINFO", 1 }, { "XREAD", after_streams }, { "XREADGROUP", after_streams },
+			{ "KEYS", no_key }, { "RANDOMKEY", no_key }, { "SCAN", no_key },
+		};
+		auto it = _index.find(_cmd);
+		return it == _index.end() ? 0 : it->second;
+	}
+
+	//԰ڵֵĶkey,ÿĸ,0ʾ
+	static size_t split_stride(const std::string& _cmd)
+	{
+		if (_cmd == "MGET" || _cmd == "DEL" || _cmd == "EXISTS" || _cmd == "UNLINK" || _cmd == "TOUCH") {
+			return 1;
+		}
+		if (_cmd == "MSET") {
+			return 2;
+		}
+		return 0;
+	}
+
+	//Ԫչ_argv,Ҫֵ
+	template<typename T>
+	static void flatten(std::vector<std::string>& _argv, const T& _arg) {
+		_argv.push_back(redis_command_text()(_arg));
+	}
+	template<typename IT>
+	static void flatten(std::vector<std::string>& _argv, const redis_arg_range<IT>& _arg) {
+		_arg.for_each([&](const auto& _v) { _argv.push_back(redis_command_text()(_v)); });
+	}
+	template<typename IT>
+	static void flatten(std::vector<std::string>& _argv, const redis_pair_range<IT>& _arg) {
+		_arg.for_each([&](const auto& _v) { _argv.push_back(redis_command_text()(_v)); });
+	}
+	static void flatten(std::vector<std::string>& _argv, const redis_command_args& _arg) {
+		_arg.for_each([&](const redis_arg_view& _v) { _argv.emplace_back(_v.data, _v.size); });
+	}
+
+	size_t get_node(const std::string& _host, int _port)
+	{
+		for (size_t i = 0; i < nodes.size(); i++) {
+			if (nodes[i].port == _port && nodes[i].host == _host) {
+				return i;
+			}
+		}
+		redis_test(nodes.size() < no_node);
+		node _node = { _host, _port, nullptr };
+		nodes.push_back(_node);
+		return nodes.size() - 1;
+	}
+
+	redisContext* get_context(size_t _node)
+	{
+		node& _n = nodes[_node];
+		if (_n.context != nullptr && _n.context->err) {
+			drop_context(_node);
+		}
+		if (_n.context == nullptr) {
+			_n.context = connect(_n.host, _n.port);
+			if (_n.context != nullptr && _n.context->err) {
+				std::string _describe = _n.context->errstr;
+				drop_context(_node);
+				throw redis_error(redis_error_code::command_error, _describe, "CONNECT");
+			}
+			redis_test(_n.context != nullptr, redis_error_code::command_error, "CONNECT");
+		}
+		return _n.context;
+	}
+
+	void drop_context(size_t _node)
+	{
+		if (nodes[_node].context != nullptr) {
+			redisFree(nodes[_node].context);
+			nodes[_node].context = nullptr;
+		}
+	}
+
+	size_t route(int _slot)
+	{
+		if (stale && std::chrono::steady_clock::now() - last_refresh > refresh_interval) {
+			try {
+				refresh();
+			}
+			catch (const redis_error&) {
+				//ˢʧʱʹþɱ,ض
+			}
+		}
+		if (_slot >= 0 && slots[_slot] != no_node) {
+			return slots[_slot];
+		}
+		for (int i = 0; i < redis_cluster_slot::slot_count; i++) {
+			if (slots[i] != no_node) {
+				return slots[i];
+			}
+		}
+		return 0;
+	}
+
+	//"MOVED 3999 127.0.0.1:6381""ASK 3999 :6381"
+	bool parse_redirect(const redisReply* _reply, size_t _from, bool& _ask, size_t& _node)
+	{
+		if (_reply == nullptr || _reply->type != REDIS_REPLY_ERROR || _reply->str == nullptr) {
+			return false;
+		}
+		std::string _str(_reply->str, _reply->len);
+		if (_str.compare(0, 6, "MOVED ") == 0) {
+			_ask = false;
+		}
+		else if (_str.compare(0, 4, "ASK ") == 0) {
+			_ask = true;
+		}
+		else {
+			return false;
+		}
+
+		size_t _p1 = _str.find(' ');
+		size_t _p2 = _str.find(' ', _p1 + 1);
+		size_t _colon = _str.rfind(':');
+		if (_p2 == std::string::npos || _colon == std::string::npos || _colon < _p2) {
+			return false;
+		}
+		int _slot = atoi(_str.c_str() + _p1 + 1);
+		std::string _host = _str.substr(_p2 + 1, _colon - _p2 - 1);
+		if (_host.empty()) {
+			_host = nodes[_from].host;
+		}
+		_node = get_node(_host, atoi(_str.c_str() + _colon + 1));
+
+		if (!_ask && _slot >= 0 && _slot < redis_cluster_slot::slot_count) {
+			slots[_slot] = (uint16_t)_node;
+			stale = true;
+		}
+		return true;
+	}
+
+	//ֻ,Ͽʱ԰ȫط
+	static bool is_read_only(const std::string& _cmd)
+	{
+		static const std::set<std::string> _read_only = {
+			"GET", "MGET", "STRLEN", "GETRANGE", "GETBIT", "BITCOUNT", "BITPOS",
+			"EXISTS", "TYPE", "TTL", "PTTL", "DUMP", "OBJECT", "KEYS", "SCAN", "RANDOMKEY",
+			"HGET", "HMGET", "HGETALL", "HKEYS", "HVALS", "HLEN", "HEXISTS", "HSTRLEN", "HSCAN",
+			"LRANGE", "LLEN", "LINDEX",
+			"SMEMBERS", "SISMEMBER", "SCARD", "SINTER", "SUNION", "SDIFF", "SSCAN",
+			"ZRANGE", "ZREVRANGE", "ZRANGEBYSCORE", "ZREVRANGEBYSCORE", "ZRANGEBYLEX", "ZREVRANGEBYLEX",
+			"ZSCORE", "ZCARD", "ZCOUNT", "ZLEXCOUNT", "ZRANK", "ZREVRANK", "ZSCAN",
+			"XRANGE", "XREVRANGE", "XLEN", "XINFO", "XREAD", "PFCOUNT",
+		};
+		return _read_only.count(_cmd) > 0;
+	}
+
+	static bool is_retryable(const redisReply* _reply)
+	{
+		return _reply != nullptr && _reply->type == REDIS_REPLY_ERROR && _reply->str != nullptr
+			&& (strncmp(_reply->str, "TRYAGAIN", 8) == 0 || strncmp(_reply->str, "CLUSTERDOWN", 11) == 0);
+	}
+
+	//slotӦĽڵִ,MOVED/ASK
+	//ǰʧʱˢ˺,ӶϿʱֻֻ,INCRִ
+	template<typename... ARGS>
+	redis_reply execute_slot(int _slot, const std::string& _cmd, ARGS&&... _args)
+	{
+		size_t _node = route(_slot);
+		bool _ask = false;
+		for (int i = 0;; i++)
+		{
+			redisContext* _context = nullptr;
+			bool _appended = false;
+			try {
+				_context = get_context(_node);
+				std::string _text;
+				try {
+					if (_ask) {
+						redis_append_command(_context, "ASKING");
+					}
+					_text = redis_append_command(_context, _cmd, _args...);
+				}
+				catch (const redis_error&) {
+					//ASKINGѾ,
+					drop_context(_node);
+					_context = nullptr;
+					throw;
+				}
+				_appended = true;
+				if (_ask) {
+					redis_get_reply(_context, "ASKING");
+				}
+				redis_reply _reply = redis_get_reply(_context, _text);
+
+				size_t _target = 0;
+				if (i < max_redirects && parse_redirect(_reply, _node, _ask, _target)) {
+					_node = _target;
+					continue;
+				}
+				if (i < max_redirects && is_retryable(_reply)) {
+					std::this_thread::sleep_for(std::chrono::milliseconds(10 << (i < 5 ? i : 5)));
+					_ask = false;
+					_node = route(_slot);
+					continue;
+				}
+				return _reply;
+			}
+			catch (const redis_error&) {
+				if (_context != nullptr && !_context->err) {
+					throw;
+				}
+				drop_context(_node);
+				stale = true;
+				last_refresh = std::chrono::steady_clock::time_point();
+				if (i >= max_redirects || (_appended && !is_read_only(_cmd))) {
+					throw;
+				}
+				_ask = false;
+				_node = route(_slot);
+			}
+		}
+	}
+
+	//ÿslotڵȡһslot,ڰýڵ
+	std::vector<int> master_slots()const
+	{
+		std::vector<char> _seen(nodes.size(), 0);
+		std::vector<int> _slots;
+		for (int i = 0; i < redis_cluster_slot::slot_count; i++) {
+			if (slots[i] != no_node && !_seen[slots[i]]) {
+				_seen[slots[i]] = 1;
+				_slots.push_back(i);
+			}
+		}
+		return _slots;
+	}
+
+	//KEYSÿڵ,ڵ˳ƴ
+	template<typename... ARGS>
+	redis_reply execute_keys(const std::string& _cmd, ARGS&&... _args)
+	{
+		auto _holder = std::make_shared<std::vector<redis_reply>>();
+		size_t _count = 0;
+		for (auto _slot : master_slots()) {
+			redis_reply _reply = execute_slot(_slot, _cmd, _args...);
+			const redisReply* _keys = _reply;
+			if (_keys == nullptr || _keys->type != REDIS_REPLY_ARRAY) {
+				return _reply;
+			}
+			_count += _keys->elements;
+			_holder->push_back(std::move(_reply));
+		}
+
+		redisReply* _merged = (redisReply*)calloc(1, sizeof(redisReply));
+		std::shared_ptr<redisReply> _ref(_merged, [_holder](redisReply* _r) {
+			free(_r->element);
+			free(_r);
+		});
+		_merged->type = REDIS_REPLY_ARRAY;
+		_merged->elements = _count;
+		_merged->element = (redisReply**)calloc(_count + 1, sizeof(redisReply*));
+		size_t _n = 0;
+		for (auto& _reply : *_holder) {
+			const redisReply* _keys = _reply;
+			for (size_t i = 0; i < _keys->elements; i++) {
+				_merged->element[_n++] = _keys->element[i];
+			}
+		}
+		return redis_reply(_merged, _ref, _cmd);
+	}
+
+	//RANDOMKEYڵ㿪ʼ,صһǿյĻӦ
+	redis_reply execute_randomkey(const std::string& _cmd)
+	{
+		std::vector<int> _slots = master_slots();
+		if (_slots.empty()) {
+			return execute_slot(-1, _cmd);
+		}
+		size_t _start = (size_t)std::hash<std::thread::id>()(std::this_thread::get_id())
+			^ (size_t)std::chrono::steady_clock::now().time_since_epoch().count();
+		for (size_t i = 0;; i++) {
+			redis_reply _reply = execute_slot(_slots[(_start + i) % _slots.size()], _cmd);
+			const redisReply* _key = _reply;
+			if (i + 1 == _slots.size() || _key == nullptr || _key->type != REDIS_REPLY_NIL) {
+				return _reply;
+			}
+		}
+	}
+
+	//ϲڵֺĻӦ,صredis_replyøֵĻӦ
+	redis_reply merge(const std::string& _cmd, size_t _count, std::vector<part>& _parts)
+	{
+		for (auto& _part : _parts) {
+			const redisReply* _reply = _part.reply;
+			if (_reply == nullptr || _reply->type == REDIS_REPLY_ERROR) {
+				return std::move(_part.reply);
+			}
+		}
+		if (_parts.size() == 1 && _parts[0].items.size() == _count) {
+			return std::move(_parts[0].reply);
+		}
+
+		auto _holder = std::make_shared<std::vector<redis_reply>>();
+		redisReply* _merged = (redisReply*)calloc(1, sizeof(redisReply));
+		std::shared_ptr<redisReply> _ref(_merged, [_holder](redisReply* _r) {
+			free(_r->element);
+			free(_r);
+		});
+
+		if (_cmd == "MGET") {
+			_merged->type = REDIS_REPLY_ARRAY;
+			_merged->elements = _count;
+			_merged->element = (redisReply**)calloc(_count + 1, sizeof(redisReply*));
+			for (auto& _part : _parts) {
+				const redisReply* _reply = _part.reply;
+				redis_test(_reply->type == REDIS_REPLY_ARRAY && _reply->elements == _part.items.size(),
+					redis_error_code::reply_type_incorrect, _part.cmd);
+				for (size_t i = 0; i < _part.items.size(); i++) {
+					_merged->element[_part.items[i]] = _reply->element[i];
+				}
+			}
+		}
+		else if (_cmd == "MSET") {
+			return std::move(_parts[0].reply);
+		}
+		else {
+			_merged->type = REDIS_REPLY_INTEGER;
+			for (auto& _part : _parts) {
+				const redisReply* _reply = _part.reply;
+				redis_test(_reply->type == REDIS_REPLY_INTEGER, redis_error_code::reply_type_incorrect, _part.cmd);
+				_merged->integer += _reply->integer;
+			}
+		}
+
+		for (auto& _part : _parts) {
+			_holder->push_back(std::move(_part.reply));
+		}
+		return redis_reply(_merged, _ref, _cmd);
+	}
+
+	void build_argv(const std::vector<std::string>& argv, size_t _stride, part& _part)
+	{
+		_part.argv.clear();
+		_part.argv.reserve(_part.items.size() * _stride);
+		for (auto _item : _part.items) {
+			for (size_t j = 0; j < _stride; j++) {
+				_part.argv.push_back(argv[_item * _stride + j]);
+			}
+		}
+	}
+
+	//keyslot(slotĶkeyᱻܾ),ÿڵϵĸһˮ
+	//нڵȫζȡ,ĳһַضʧʱ
+	//ѾûжӦĲֻֻʱ
+	redis_reply execute_split(const std::string& _cmd, const std::vector<std::string>& argv, size_t _stride)
+	{
+		size_t _count = argv.size() / _stride;
+		redis_test(_count > 0 && argv.size() % _stride == 0, redis_error_code::test_failed, _cmd);
+
+		std::vector<part> _parts;
+		std::unordered_map<uint16_t, size_t> _part_of_slot;
+		for (size_t i = 0; i < _count; i++) {
+			uint16_t _slot = redis_cluster_slot::get(argv[i * _stride]);
+			auto it = _part_of_slot.find(_slot);
+			if (it == _part_of_slot.end()) {
+				it = _part_of_slot.insert(std::make_pair(_slot, _parts.size())).first;
+				_parts.push_back(part());
+				_parts.back().slot = _slot;
+				_parts.back().node = route(_slot);
+			}
+			_parts[it->second].items.push_back(i);
+		}
+		if (_parts.size() == 1) {
+			return execute_slot(_parts[0].slot, _cmd, argv);
+		}
+
+		std::vector<char> _failed(nodes.size(), 0);
+		for (auto& _part : _parts) {
+			if (_failed[_part.node]) {
+				continue;
+			}
+			build_argv(argv, _stride, _part);
+			try {
+				_part.cmd = redis_append_command(get_context(_part.node), _cmd, _part.argv);
+				_part.sent = true;
+			}
+			catch (const redis_error&) {
+				//ýڵѾ׷ӵĲֻ,,ЩԺ󵥶
+				_failed[_part.node] = 1;
+				drop_context(_part.node);
+				for (auto& _other : _parts) {
+					if (_other.node == _part.node) {
+						_other.sent = false;
+					}
+				}
+			}
+		}
+		std::vector<char> _flushed(nodes.size(), 0);
+		for (auto& _part : _parts) {
+			if (_part.sent && !_failed[_part.node] && !_flushed[_part.node]) {
+				_flushed[_part.node] = 1;
+				int _done = 0;
+				while (!_done && redisBufferWrite(nodes[_part.node].context, &_done) == REDIS_OK) {
+				}
+			}
+		}
+
+		//ȶˮеĻӦ,,ԵͬһֵĻӦ
+		std::vector<part*> _retry;
+		for (auto& _part : _parts)
+		{
+			bool _ask = false;
+			size_t _target = 0;
+			if (_part.sent && !_failed[_part.node]) {
+				try {
+					_part.reply = redis_get_reply(nodes[_part.node].context, _part.cmd);
+				}
+				catch (const redis_error& e) {
+					//ϻδĻӦ,,ʱλ
+					_failed[_part.node] = 1;
+					for (auto& _other : _parts) {
+						if (_other.node == _part.node && _other.sent) {
+							_other.error = e.describe;
+						}
+					}
+					drop_context(_part.node);
+					stale = true;
+				}
+			}
+			if (!_part.sent || _failed[_part.node]
+				|| parse_redirect(_part.reply, _part.node, _ask, _target) || is_retryable(_part.reply)) {
+				_retry.push_back(&_part);
+			}
+		}
+		for (auto _part : _retry) {
+			const redisReply* _reply = _part->reply;
+			if (_part->sent && _reply == nullptr && !is_read_only(_cmd)) {
+				throw redis_error(redis_error_code::command_error, _part->error, _part->cmd);
+			}
+			if (_part->argv.empty()) {
+				build_argv(argv, _stride, *_part);
+			}
+			_part->cmd = _cmd;
+			_part->reply = execute_slot(_part->slot, _cmd, _part->argv);
+		}
+
+		return merge(_cmd, _count, _parts);
+	}
+
+	void drop_context_if_broken(size_t _node)
+	{
+		if (nodes[_node].context != nullptr && nodes[_node].context->err) {
+			drop_context(_node);
+			stale = true;
+		}
+	}
+
+	void init(const std::vector<std::pair<std::string, int>>& _seeds)
+	{
+		slots.reset(new uint16_t[redis_cluster_slot::slot_count]);
+		std::fill(slots.get(), slots.get() + redis_cluster_slot::slot_count, (uint16_t)no_node);
+		for (auto& _seed : _seeds) {
+			get_node(_seed.first, _seed.second);
+		}
+		redis_test(!nodes.empty());
+		refresh();
+	}
+
+	redis_cluster_context(const redis_cluster_context&) = delete;
+	redis_cluster_context& operator =(const redis_cluster_context&) = delete;
+public:
+	//_connect𴴽ָڵ(AUTH),ʧܷnullptrerr
+	redis_cluster_context(std::function<redisContext*(const std::string&, int)> _connect,
+		const std::vector<std::pair<std::string, int>>& _seeds, int _max_redirects = 5) :
+		connect(_connect), max_redirects(_max_redirects), stale(false),
+		refresh_interval(std::chrono::milliseconds(100))
+	{
+		init(_seeds);
+	}
+
+	redis_cluster_context(const std::vector<std::pair<std::string, int>>& _seeds,
+		std::chrono::milliseconds _timeout = std::chrono::milliseconds(1000), int _max_redirects = 5) :
+		connect([_timeout](const std::string& _host, int _port) { return redis_connect(_host, _port, _timeout); }),
+		max_redirects(_max_redirects), stale(false), refresh_interval(std::chrono::milliseconds(100))
+	{
+		init(_seeds);
+	}
+
+	~redis_cluster_context()
+	{
+		for (size_t i = 0; i < nodes.size(); i++) {
+			drop_context(i);
+		}
+	}
+
+	//CLUSTER SLOTSؽslot,γ֪Ľڵ
+	void refresh()
+	{
+		std::string _describe;
+		for (size_t n = 0; n < nodes.size(); n++)
+		{
+			try {
+				redis_reply _reply(get_context(n), "CLUSTER", "SLOTS");
+				const redisReply* _slots = _reply;
+				redis_test(_slots != nullptr && _slots->type == REDIS_REPLY_ARRAY,
+					redis_error_code::reply_type_incorrect, "CLUSTER SLOTS");
+
+				std::unique_ptr<uint16_t[]> _table(new uint16_t[redis_cluster_slot::slot_count]);
+				std::fill(_table.get(), _table.get() + redis_cluster_slot::slot_count, (uint16_t)no_node);
+				for (size_t i = 0; i < _slots->elements; i++) {
+					const redisReply* _range = _slots->element[i];
+					if (_range->type != REDIS_REPLY_ARRAY || _range->elements < 3
+						|| _range->element[2]->type != REDIS_REPLY_ARRAY || _range->element[2]->elements < 2) {
+						continue;
+					}
+					const redisReply* _master = _range->element[2];
+					std::string _host(_master->element[0]->str ? _master->element[0]->str : "", _master->element[0]->len);
+					if (_host.empty() || _host == "?") {
+						_host = nodes[n].host;
+					}
+					size_t _node = get_node(_host, (int)_master->element[1]->integer);
+					int64_t _begin = _range->element[0]->integer;
+					int64_t _end = _range->element[1]->integer;
+					for (int64_t s = _begin; s <= _end && s < redis_cluster_slot::slot_count; s++) {
+						if (s >= 0) {
+							_table[s] = (uint16_t)_node;
+						}
+					}
+				}
+
+				slots.swap(_table);
+				stale = false;
+				last_refresh = std::chrono::steady_clock::now();
+				return;
+			}
+			catch (const redis_error& e) {
+				drop_context_if_broken(n);
+				_describe = e.describe;
+			}
+		}
+		throw redis_error(redis_error_code::command_error, _describe, "CLUSTER SLOTS");
+	}
+
+	//ǰslotڵ
+	std::vector<std::pair<std::string, int>> masters()const
+	{
+		std::vector<std::pair<std::string, int>> _masters;
+		for (auto _slot : master_slots()) {
+			_masters.push_back(std::make_pair(nodes[slots[_slot]].host, nodes[slots[_slot]].port));
+		}
+		return _masters;
+	}
+
+	//ÿڵһɨԴ,ʹ뱾ͬķʽ,redis_parallel_scan
+	std::vector<std::function<redisContext*()>> scan_sources()const
+	{
+		std::vector<std::function<redisContext*()>> _sources;
+		auto _connect = connect;
+		for (auto& _master : masters()) {
+			_sources.push_back([_connect, _master]() { return _connect(_master.first, _master.second); });
+		}
+		return _sources;
+	}
+
+	//keyڵslotǰӦĽڵ
+	redisContext* get_context(const std::string& key) {
+		return get_context(route(redis_cluster_slot::get(key)));
+	}
+
+	//ʹòִ,key_indexλõĲ·
+	template<typename... ARGS, typename = typename std::enable_if<!is_redis_command_argv<typename std::decay<ARGS>::type...>::value>::type>
+	redis_reply execute(const std::string& _cmd, ARGS&&... _args)
+	{
+		//keyĲҪslot,չstd::vector<std::string>
+		bool _ranges[] = { false, is_redis_command_range<typename std::decay<ARGS>::type>::value... };
+		if (std::find(std::begin(_ranges), std::end(_ranges), true) != std::end(_ranges) && split_stride(_cmd) > 0) {
+			std::vector<std::string> _argv;
+			int tmp[] = { 0, (flatten(_argv, _args), 0)... };
+			(void)tmp;//for warning
+			return execute(_cmd, _argv);
+		}
+
+		if (_cmd == "KEYS") {
+			return execute_keys(_cmd, std::forward<ARGS>(_args)...);
+		}
+		if (_cmd == "RANDOMKEY") {
+			return execute_randomkey(_cmd);
+		}
+
+		int _index = key_index(_cmd);
+		redis_cluster_key _key(_index < 0 ? 0 : (size_t)_index, _index == after_streams ? "STREAMS" : nullptr);
+		if (_index != no_key) {
+			int tmp[] = { 0, (_key(_args), 0)... };
+			(void)tmp;//for warning
+		}
+		return execute_slot(_key.found ? (int)redis_cluster_slot::get(_key.key) : -1, _cmd, std::forward<ARGS>(_args)...);
+	}
+
+	//ʹstd::vector<std::string>ִ,keyڵ
+	redis_reply execute(const std::string& _cmd, const std::vector<std::string>& argv)
+	{
+		size_t _stride = split_stride(_cmd);
+		if (_stride > 0 && !argv.empty()) {
+			return execute_split(_cmd, argv, _stride);
+		}
+		int _index = key_index(_cmd);
+		if (_index == after_streams) {
+			auto it = std::find_if(argv.begin(), argv.end(), [](const std::string& _arg) { return _stricmp(_arg.c_str(), "STREAMS") == 0; });
+			_index = it == argv.end() ? no_key : (int)(it - argv.begin()) + 1;
+		}
+		int _slot = (_index >= 0 && (size_t)_index < argv.size()) ? (int)redis_cluster_slot::get(argv[_index]) : -1;
+		return execute_slot(_slot, _cmd, argv);
+	}
+
+	redis_key<redis_cluster_driver> key() {
+		return redis_key<redis_cluster_driver>(this);
+	}
+	redis_string<redis_cluster_driver> string() {
+		return redis_string<redis_cluster_driver>(this);
+	}
+	redis_hash<redis_cluster_driver> hash() {
+		return redis_hash<redis_cluster_driver>(this);
+	}
+	redis_list<redis_cluster_driver> list() {
+		return redis_list<redis_cluster_driver>(this);
+	}
+	redis_set<redis_cluster_driver> set() {
+		return redis_set<redis_cluster_driver>(this);
+	}
+	redis_sortedset<redis_cluster_driver> sortedset() {
+		return redis_sortedset<redis_cluster_driver>(this);
+	}
+	redis_stream<redis_cluster_driver> stream() {
+		return redis_stream<redis_cluster_driver>(this);
+	}
+};
+
+template<typename CONVERT, typename... ARGS>
+typename CONVERT::result_type redis_cluster_driver::command(const CONVERT& _convert, const std::string& _cmd, ARGS&&... _args) {
+	return _convert(cluster->execute(_cmd, std::forward<ARGS>(_args)...));
+}
+
+template<typename BUILD, typename ON_REPLY>
+void redis_cluster_driver::chunked(const std::string& _cmd, size_t _count, size_t _chunk_size,
+	BUILD _build, ON_REPLY _on_reply, size_t /*_window*/)
+{
+	redis_test(_chunk_size > 0);
+
+	redis_command_args _argv;
+	for (size_t _begin = 0; _begin < _count; _begin += _chunk_size) {
+		size_t _end = std::min(_count, _begin + _chunk_size);
+		_argv.clear();
+		_build(_begin, _end, _argv);
+		redis_reply _reply = cluster->execute(_cmd, _argv);
+		_on_reply(_begin, _end, _reply);
+	}
+}
+
+/*
+	һ򵥵
+
+	redis_cluster_context _cluster({ { "127.0.0.1", 7000 }, { "127.0.0.1", 7001 } });
+	_cluster.string().SET("{user:1}:name", "tom");
+	auto _values = _cluster.string().MGET({ "a", "b", "c" });	//ڵ,ԭ˳򷵻
+*/
+
+#ifdef TC_REDIS
+}
+#endif
+
+#endif
@@ -0,0 +1,641 @@
+#pragma once
+
+#ifndef __REDIS_COMMAND_H__
+#define __REDIS_COMMAND_H__
+
+#ifdef TC_REDIS
+namespace TC_REDIS {
+#endif
+
+//жϲǷstd::vector<std::string>
+template<typename... ARGS>
+class is_redis_command_argv {
+public:
+	enum { value = false };
+};
+
+template<>
+class is_redis_command_argv<std::vector<std::string>> {
+public:
+	enum { value = true };
+};
+
+//ĿID,"ʱ-"
+struct redis_stream_id {
+	uint64_t ms;
+	uint64_t seq;
+
+	redis_stream_id() :ms(0), seq(0) {}
+	redis_stream_id(uint64_t _ms, uint64_t _seq) :ms(_ms), seq(_seq) {}
+
+	//"ms-seq""ms",ʧܷfalse
+	static bool parse(const char* _str, size_t _len, redis_stream_id& _id)
+	{
+		uint64_t* _part = &_id.ms;
+		_id.ms = 0;
+		_id.seq = 0;
+		bool _digit = false;
+		for (size_t i = 0; i < _len; i++) {
+			char c = _str[i];
+			if (c == '-' && _part == &_id.ms && _digit) {
+				_part = &_id.seq;
+				_digit = false;
+			}
+			else if (c >= '0' && c <= '9' && *_part <= (UINT64_MAX - (uint64_t)(c - '0')) / 10) {
+				*_part = *_part * 10 + (uint64_t)(c - '0');
+				_digit = true;
+			}
+			else {
+				return false;
+			}
+		}
+		return _digit;
+	}
+
+	//д"ms-seq",pҪ42ֽ,س
+	size_t format(char* p)const
+	{
+		char* _begin = p;
+		uint64_t _parts[] = { ms, seq };
+		for (size_t i = 0; i < 2; i++) {
+			if (i > 0) {
+				*p++ = '-';
+			}
+			char tmp[20];
+			size_t n = 0;
+			uint64_t v = _parts[i];
+			do {
+				tmp[n++] = (char)('0' + v % 10);
+				v /= 10;
+			} while (v);
+			while (n) {
+				*p++ = tmp[--n];
+			}
+		}
+		return (size_t)(p - _begin);
+	}
+
+	std::string to_string()const {
+		char tmp[48];
+		return std::string(tmp, format(tmp));
+	}
+
+	bool operator ==(const redis_stream_id& _id)const { return ms == _id.ms && seq == _id.seq; }
+	bool operator !=(const redis_stream_id& _id)const { return !(*this == _id); }
+	bool operator <(const redis_stream_id& _id)const { return ms < _id.ms || (ms == _id.ms && seq < _id.seq); }
+};
+
+//жܷΪд
+template<typename T>
+class is_redis_command_arg {
+public:
+	enum {
+		value = std::is_arithmetic<T>::value || std::is_enum<T>::value
+			|| std::is_same<T, std::string>::value
+			|| std::is_same<T, redis_stream_id>::value
+			|| std::is_convertible<T, const char*>::value
+#ifdef REDIS_HAS_STRING_VIEW
+			|| std::is_same<T, std::string_view>::value
+#endif
+	};
+};
+
+//õ÷ڴһβ,дʱԪչ,мstd::vector<std::string>
+//Ԫؿstd::string,std::string_view,const char*,򸡵
+//õڴд֮ǰһֱЧ
+template<typename IT>
+class redis_arg_range {
+protected:
+	IT first;
+	IT last;
+	size_t count;
+public:
+	redis_arg_range(IT _first, IT _last) :first(_first), last(_last), count((size_t)std::distance(_first, _last)) {}
+
+	//չĲ
+	size_t size()const { return count; }
+
+	template<typename F>
+	void for_each(F&& _f)const
+	{
+		for (IT it = first; it != last; ++it) {
+			_f(*it);
+		}
+	}
+};
+
+//õ÷ڴһpair,first,secondչ,swapΪtrueʱsecond,firstչ(ZADDscore member)
+//pairstd::map,std::unordered_map,std::vector<std::pair<...>>,Ҫ
+template<typename IT>
+class redis_pair_range {
+protected:
+	IT first;
+	IT last;
+	size_t count;
+	bool swap;
+public:
+	redis_pair_range(IT _first, IT _last, bool _swap) :
+		first(_first), last(_last), count((size_t)std::distance(_first, _last)), swap(_swap) {}
+
+	size_t size()const { return count * 2; }
+
+	template<typename F>
+	void for_each(F&& _f)const
+	{
+		for (IT it = first; it != last; ++it) {
+			if (swap) {
+				_f(it->second);
+				_f(it->first);
+			}
+			else {
+				_f(it->first);
+				_f(it->second);
+			}
+		}
+	}
+};
+
+//жǷredis_arg_rangeredis_pair_range
+template<typename T>
+class is_redis_command_range {
+public:
+	enum { value = false };
+};
+
+template<typename IT>
+class is_redis_command_range<redis_arg_range<IT>> {
+public:
+	enum { value = true };
+};
+
+template<typename IT>
+class is_redis_command_range<redis_pair_range<IT>> {
+public:
+	enum { value = true };
+};
+
+//һڴ,redis_command_argsչ
+struct redis_arg_view {
+	const char* data;
+	size_t size;
+};
+
+class redis_command_args;
+
+template<>
+class is_redis_command_range<redis_command_args> {
+public:
+	enum { value = true };
+};
+
+//жԪܷΪ(std::vector,std::span,std::list)
+template<typename C, typename = void>
+class is_redis_arg_container {
+public:
+	enum { value = false };
+};
+
+template<typename C>
+class is_redis_arg_container<C, decltype((void)std::begin(std::declval<const C&>()))> {
+public:
+	enum {
+		value = !is_redis_command_arg<C>::value
+			&& is_redis_command_arg<typename std::decay<decltype(*std::begin(std::declval<const C&>()))>::type>::value
+	};
+};
+
+//жԪܷΪ(first, second)
+template<typename C, typename = void>
+class is_redis_pair_container {
+public:
+	enum { value = false };
+};
+
+template<typename C>
+class is_redis_pair_container<C, decltype((void)std::begin(std::declval<const C&>())->second)> {
+	typedef decltype(*std::begin(std::declval<const C&>())) element_type;
+public:
+	enum {
+		value = is_redis_command_arg<typename std::decay<decltype(std::declval<element_type>().first)>::type>::value
+			&& is_redis_command_arg<typename std::decay<decltype(std::declval<element_type>().second)>::type>::value
+	};
+};
+
+template<typename C>
+redis_arg_range<decltype(std::begin(std::declval<const C&>()))> redis_args(const C& _c) {
+	return redis_arg_range<decltype(std::begin(_c))>(std::begin(_c), std::end(_c));
+}
+
+template<typename IT>
+redis_arg_range<IT> redis_args(IT _first, IT _last) {
+	return redis_arg_range<IT>(_first, _last);
+}
+
+template<typename C>
+redis_pair_range<decltype(std::begin(std::declval<const C&>()))> redis_pairs(const C& _c, bool _swap = false) {
+	return redis_pair_range<decltype(std::begin(_c))>(std::begin(_c), std::end(_c), _swap);
+}
+
+//RESP
+//ֱӰлRESPЭı,redisAppendFormattedCommand
+//پhiredisĸʽ,ַд(֧Ƕ\0),㰴ľд
+//̸߳,²ѷ
+class redis_command_writer {
+protected:
+	std::string* buf;
+	std::string own;	//̻߳ռʱʹ
+	bool local;			//Ƿռ̻߳
+
+	enum { max_cached_capacity = 1024 * 1024 };
+
+	static std::string& local_buffer() {
+		static thread_local std::string _buf;
+		return _buf;
+	}
+	static bool& local_busy() {
+		static thread_local bool _busy = false;
+		return _busy;
+	}
+
+	//λֱ,ÿдλ
+	static const char* digits2() {
+		return
+			"00010203040506070809"
+			"10111213141516171819"
+			"20212223242526272829"
+			"30313233343536373839"
+			"40414243444546474849"
+			"50515253545556575859"
+			"60616263646566676869"
+			"70717273747576777879"
+			"80818283848586878889"
+			"90919293949596979899";
+	}
+
+	redis_command_writer(const redis_command_writer&) = delete;
+	redis_command_writer& operator =(const redis_command_writer&) = delete;
+public:
+	redis_command_writer() :local(!local_busy())
+	{
+		if (!local) {
+			buf = &own;
+		}
+		else {
+			local_busy() = true;
+			buf = &local_buffer();
+			buf->clear();
+		}
+	}
+	//׷д÷Ļ,Ҫĳ()
+	explicit redis_command_writer(std::string& _buf) :buf(&_buf), local(false)
+	{
+	}
+	~redis_command_writer()
+	{
+		if (local) {
+			//ռ̻߳
+			if (buf->capacity() > max_cached_capacity) {
+				std::string().swap(*buf);
+			}
+			local_busy() = false;
+		}
+	}
+
+	const char* data()const { return buf->data(); }
+	size_t size()const { return buf->size(); }
+
+	//ʮλ
+	static size_t digits10(uint64_t v)
+	{
+		size_t n = 1;
+		for (;;) {
+			if (v < 10) return n;
+			if (v < 100) return n + 1;
+			if (v < 1000) return n + 2;
+			if (v < 10000) return n + 3;
+			v /= 10000u;
+			n += 4;
+		}
+	}
+
+	//endǰдvʮı,÷֤ռ㹻
+	static void write_uint(char* end, uint64_t v)
+	{
+		const char* d = digits2();
+		while (v >= 100) {
+			size_t i = (size_t)(v % 100) * 2;
+			v /= 100;
+			*--end = d[i + 1];
+			*--end = d[i];
+		}
+		if (v >= 10) {
+			size_t i = (size_t)v * 2;
+			*--end = d[i + 1];
+			*--end = d[i];
+		}
+		else {
+			*--end = (char)('0' + v);
+		}
+	}
+
+	//תı,д볤,pҪ20ֽ
+	static size_t format_int(char* p, int64_t v)
+	{
+		uint64_t u = v < 0 ? 0 - (uint64_t)v : (uint64_t)v;
+		size_t n = digits10(u);
+		if (v < 0) {
+			*p++ = '-';
+		}
+		write_uint(p + n, u);
+		return n + (v < 0 ? 1 : 0);
+	}
+
+	//תı,ȡܾȷ̱ʾ,޹,pҪ32ֽ
+	static size_t format_double(char* p, double v)
+	{
+#ifdef REDIS_HAS_FLOAT_CHARCONV
+		return (size_t)(std::to_chars(p, p + 32, v).ptr - p);
+#else
+		int n = snprintf(p, 32, "%.15g", v);
+		if (strtod(p, nullptr) != v) {
+			n = snprintf(p, 32, "%.17g", v);
+		}
+		if (n <= 0) {
+			return 0;
+		}
+		//"C"С㻻'.'
+		char _point = *localeconv()->decimal_point;
+		char* _dot = _point != '.' ? (char*)memchr(p, _point, (size_t)n) : nullptr;
+		if (_dot != nullptr) {
+			*_dot = '.';
+		}
+		return (size_t)n;
+#endif
+	}
+
+	void write_count(size_t argc)
+	{
+		char tmp[24];
+		size_t n = digits10(argc);
+		write_uint(tmp + n, argc);
+		buf->push_back('*');
+		buf->append(tmp, n);
+		buf->append("\r\n", 2);
+	}
+
+	void write_bulk(const char* s, size_t len)
+	{
+		char tmp[24];
+		size_t n = digits10(len);
+		write_uint(tmp + n, len);
+		buf->reserve(buf->size() + n + len + 5);
+		buf->push_back('$');
+		buf->append(tmp, n);
+		buf->append("\r\n", 2);
+		buf->append(s, len);
+		buf->append("\r\n", 2);
+	}
+
+	template<typename T>
+	typename std::enable_if<std::is_integral<typename std::decay<T>::type>::value
+		|| std::is_enum<typename std::decay<T>::type>::value>::type
+		write_arg(T v)
+	{
+		char tmp[24];
+		write_bulk(tmp, format_int(tmp, (int64_t)v));
+	}
+
+	template<typename T>
+	typename std::enable_if<std::is_floating_point<typename std::decay<T>::type>::value>::type
+		write_arg(T v)
+	{
+		char tmp[32];
+		write_bulk(tmp, format_double(tmp, (double)v));
+	}
+
+	void write_arg(const char* v) { write_bulk(v, strlen(v)); }
+	void write_arg(const redis_arg_view& v) { write_bulk(v.data, v.size); }
+	void write_arg(const std::string& v) { write_bulk(v.data(), v.size()); }
+	void write_arg(const redis_stream_id& v) {
+		char tmp[48];
+		write_bulk(tmp, v.format(tmp));
+	}
+#ifdef REDIS_HAS_STRING_VIEW
+	void write_arg(std::string_view v) { write_bulk(v.data(), v.size()); }
+#endif
+
+	//ֱӴӵ÷ڴд
+	template<typename RANGE>
+	typename std::enable_if<is_redis_command_range<RANGE>::value>::type
+		write_arg(const RANGE& v) {
+		v.for_each([this](const auto& _v) { write_arg(_v); });
+	}
+
+	//չĸ
+	template<typename T>
+	static typename std::enable_if<!is_redis_command_range<T>::value, size_t>::type
+		arg_count(const T&) { return 1; }
+	template<typename RANGE>
+	static typename std::enable_if<is_redis_command_range<RANGE>::value, size_t>::type
+		arg_count(const RANGE& v) { return v.size(); }
+
+	//ʹòд
+	template<typename... ARGS, typename = typename std::enable_if<!is_redis_command_argv<typename std::decay<ARGS>::type...>::value>::type>
+	redis_command_writer& command(const std::string& _cmd, ARGS&&... _args)
+	{
+		size_t _argc = 1;
+		int tmp0[] = { 0, (_argc += arg_count(_args), 0)... };
+		(void)tmp0;//for warning
+		write_count(_argc);
+		write_bulk(_cmd.data(), _cmd.size());
+		int tmp[] = { 0, (write_arg(_args), 0)... };
+		(void)tmp;//for warning
+		return *this;
+	}
+
+	//ʹstd::vector<std::string>д
+	redis_command_writer& command(const std::string& _cmd, const std::vector<std::string>& argv)
+	{
+		write_count(1 + argv.size());
+		write_bulk(_cmd.data(), _cmd.size());
+		for (auto& _arg : argv) {
+			write_bulk(_arg.data(), _arg.size());
+		}
+		return *this;
+	}
+};
+
+//facadeڲ,ʱstd::vector<std::string>
+//ַֻ¼ָͳ,ؼ("EX","LIMIT")ֱָ,ָʽ
+//inline_count,ıinline_bytesֽʱѷ
+//,ıд밴arena,clear()֮ѷڴ()
+//õַд֮ǰһֱЧ,˲ʱstd::string,Ҳܸ
+class redis_command_args {
+protected:
+	enum { inline_count = 16, inline_bytes = 256, arena_block = 4096 };
+
+	redis_arg_view inline_args[inline_count];
+	char inline_text[inline_bytes];
+	size_t count;
+	size_t text_used;
+	bool spilled;
+	std::vector<redis_arg_view> heap_args;
+	std::vector<std::unique_ptr<char[]>> arena;
+	size_t arena_index;
+	size_t arena_used;
+
+	redis_command_args(const redis_command_args&) = delete;
+	redis_command_args& operator =(const redis_command_args&) = delete;
+
+	const redis_arg_view* args()const { return spilled ? heap_args.data() : inline_args; }
+
+	//ı,ȶĵַ
+	const char* store(const char* s, size_t n)
+	{
+		char* p;
+		if (text_used + n <= inline_bytes) {
+			p = inline_text + text_used;
+			text_used += n;
+		}
+		else {
+			if (arena_index < arena.size() && arena_used + n > arena_block) {
+				arena_index++;
+				arena_used = 0;
+			}
+			if (arena_index == arena.size()) {
+				arena.emplace_back(new char[arena_block]);
+			}
+			p = arena[arena_index].get() + arena_used;
+			arena_used += n;
+		}
+		memcpy(p, s, n);
+		return p;
+	}
+public:
+	redis_command_args() :count(0), text_used(0), spilled(false), arena_index(0), arena_used(0) {
+	}
+
+	size_t size()const { return count; }
+	bool empty()const { return count == 0; }
+	const redis_arg_view& operator [](size_t i)const { return args()[i]; }
+
+	void clear()
+	{
+		count = 0;
+		text_used = 0;
+		spilled = false;
+		heap_args.clear();
+		arena_index = 0;
+		arena_used = 0;
+	}
+
+	void push_back(const char* v, size_t len)
+	{
+		redis_arg_view _view = { v, len };
+		if (spilled) {
+			heap_args.push_back(_view);
+		}
+		else if (count < inline_count) {
+			inline_args[count] = _view;
+		}
+		else {
+			heap_args.reserve(inline_count * 2);
+			heap_args.assign(inline_args, inline_args + count);
+			heap_args.push_back(_view);
+			spilled = true;
+		}
+		count++;
+	}
+
+	void push_back(const char* v) { push_back(v, strlen(v)); }
+	void push_back(const std::string& v) { push_back(v.data(), v.size()); }
+	void push_back(std::string&&) = delete;
+#ifdef REDIS_HAS_STRING_VIEW
+	void push_back(std::string_view v) { push_back(v.data(), v.size()); }
+#endif
+	void push_back(const redis_stream_id& v) {
+		char tmp[48];
+		size_t n = v.format(tmp);
+		push_back(store(tmp, n), n);
+	}
+
+	template<typename T>
+	typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+		push_back(T v)
+	{
+		char tmp[24];
+		size_t n = redis_command_writer::format_int(tmp, (int64_t)v);
+		push_back(store(tmp, n), n);
+	}
+
+	template<typename T>
+	typename std::enable_if<std::is_floating_point<T>::value>::type
+		push_back(T v)
+	{
+		char tmp[32];
+		size_t n = redis_command_writer::format_double(tmp, (double)v);
+		push_back(store(tmp, n), n);
+	}
+
+	template<typename IT>
+	void append(IT _first, IT _last)
+	{
+		for (; _first != _last; ++_first) {
+			push_back(*_first);
+		}
+	}
+
+	template<typename F>
+	void for_each(F&& _f)const
+	{
+		const redis_arg_view* _args = args();
+		for (size_t i = 0; i < count; i++) {
+			_f(_args[i]);
+		}
+	}
+};
+
+//Ⱦıĵ,ڴϢ
+class redis_command_text {
+public:
+	template<typename T>
+	typename std::enable_if<std::is_integral<typename std::decay<T>::type>::value
+		|| std::is_enum<typename std::decay<T>::type>::value, std::string>::type
+		operator ()(T v) {
+		char tmp[24];
+		return std::string(tmp, redis_command_writer::format_int(tmp, (int64_t)v));
+	}
+
+	template<typename T>
+	typename std::enable_if<std::is_floating_point<typename std::decay<T>::type>::value, std::string>::type
+		operator ()(T v) {
+		char tmp[32];
+		return std::string(tmp, redis_command_writer::format_double(tmp, (double)v));
+	}
+
+	std::string operator ()(const char* v) { return v; }
+	std::string operator ()(const redis_arg_view& v) { return std::string(v.data, v.size); }
+	const std::string& operator ()(const std::string& v) { return v; }
+	std::string operator ()(const redis_stream_id& v) { return v.to_string(); }
+#ifdef REDIS_HAS_STRING_VIEW
+	std::string operator ()(std::string_view v) { return std::string(v); }
+#endif
+
+	//䰴ո
+	template<typename RANGE>
+	typename std::enable_if<is_redis_command_range<RANGE>::value, std::string>::type
+		operator ()(const RANGE& v) {
+		std::string _text;
+		v.for_each([&](const auto& _v) {
+			_text += _text.empty() ? "" : " ";
+			_text += (*this)(_v);
+		});
+		return _text;
+	}
+};
+
+#ifdef TC_REDIS
+}
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+#pragma once
+
+#ifndef __REDIS_CONNECT_H__
+#define __REDIS_CONNECT_H__
+
+#ifdef TC_REDIS
+namespace TC_REDIS {
+#endif
+
+//ַʱ,ʧܷnullptrerr
+inline redisContext* redis_connect(const std::string& _host, int _port, std::chrono::milliseconds _timeout)
+{
+	struct timeval _tv = { (long)(_timeout.count() / 1000), (long)(_timeout.count() % 1000 * 1000) };
+	return redisConnectWithTimeout(_host.c_str(), _port, _tv);
+}
+
+//ÿεöַʱһ,ӳ,ȺҪĵط
+inline std::function<redisContext*()> redis_connector(const std::string& _host, int _port,
+	std::chrono::milliseconds _timeout = std::chrono::milliseconds(1000))
+{
+	return [_host, _port, _timeout]() { return redis_connect(_host, _port, _timeout); };
+}
+
+#ifdef __linux__
+//̨ȡ̵߳ѭ
+//run()_connectӲ_serve,_serveػ׳쳣ΪϿ,_disconnected100ms5s˱ܼ
+//ȡ߳wait()ͬʱȴsocketeventfd,stop()wake()ỽ,ӵĶʱ
+class redis_reconnect_loop
+{
+protected:
+	int wake_fd;
+	std::atomic<bool> stopping;
+	std::mutex mutex;
+	std::condition_variable cond;
+
+	redis_reconnect_loop(const redis_reconnect_loop&) = delete;
+	redis_reconnect_loop& operator =(const redis_reconnect_loop&) = delete;
+public:
+	redis_reconnect_loop() :wake_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), stopping(false)
+	{
+		redis_test(wake_fd >= 0);
+	}
+	~redis_reconnect_loop() { close(wake_fd); }
+
+	bool stopped()const { return stopping.load(); }
+
+	//ֹͣѶȡ߳
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> _lock(mutex);
+			stopping = true;
+			cond.notify_all();
+		}
+		wake();
+	}
+
+	void wake()
+	{
+		uint64_t _one = 1;
+		if (write(wake_fd, &_one, sizeof(_one)) < 0) {
+			//ʱȡ̱߳Ȼᱻ
+		}
+	}
+
+	//ȴ_fdɶ򱻻,_wokenǷ񱻻(֪ͨ),ֵʾ_fdǷɶ
+	bool wait(int _fd, bool& _woken)
+	{
+		struct pollfd _fds[2];
+		_fds[0].fd = _fd;
+		_fds[0].events = POLLIN;
+		_fds[0].revents = 0;
+		_fds[1].fd = wake_fd;
+		_fds[1].events = POLLIN;
+		_fds[1].revents = 0;
+
+		_woken = false;
+		if (poll(_fds, 2, -1) < 0) {
+			redis_test(errno == EINTR, redis_error_code::command_error, "POLL");
+			return false;
+		}
+		if (_fds[1].revents & POLLIN) {
+			uint64_t _count = 0;
+			if (read(wake_fd, &_count, sizeof(_count)) < 0) {
+				//eventfdΪ,û֪ͨʱֱӷ
+			}
+			_woken = true;
+		}
+		return (_fds[0].revents & (POLLIN | POLLERR | POLLHUP)) != 0;
+	}
+
+	template<typename SERVE, typename DISCONNECTED>
+	void run(const std::function<redisContext*()>& _connect, SERVE _serve, DISCONNECTED _disconnected)
+	{
+		std::chrono::milliseconds _backoff(100);
+		while (!stopped())
+		{
+			try {
+				std::unique_ptr<redisContext, void(*)(redisContext*)> _context(_connect(), redisFree);
+				if (_context != nullptr && !_context->err) {
+					_backoff = std::chrono::milliseconds(100);
+					_serve(_context.get());
+				}
+			}
+			catch (...) {
+			}
+			_disconnected();
+
+			std::unique_lock<std::mutex> _lock(mutex);
+			cond.wait_for(_lock, _backoff, [&]() { return stopping.load(); });
+			_backoff = std::min(_backoff * 2, std::chrono::milliseconds(5000));
+		}
+	}
+};
+#endif
+
+#ifdef TC_REDIS
+}
+#endif
+
+#endif
@@ -3,1057 +3,1983 @@
 #ifndef __REDIS_CONTEXT_H__
 #define __REDIS_CONTEXT_H__
 
-#if _MSC_VER >= 1920
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
 #   include <optional>
-#else
-#   include <memory>
+#   define REDIS_HAS_OPTIONAL
 #endif
+#include <memory>
 
 #ifdef TC_REDIS
 namespace TC_REDIS {
 #endif
 
-#if _MSC_VER >= 1920
+#ifdef REDIS_HAS_OPTIONAL
 #   define redis_optional std::optional
 #   define redis_nullopt std::nullopt
 #   define redis_make_optional(v) std::make_optional(v)
 #else
-#   define redis_optional std::unique_ptr
-#   define redis_nullopt nullptr
-#   define redis_make_optional(v) std::make_unique<decltype(v)>(v)
-#endif
-
+//C++17ǰredis_optional,ӿstd::optionalĳòһ
+//ֵڶڲ,ڴ
+struct redis_nullopt_t {
+};
 
-class redis_context
+template<typename T>
+class redis_optional_value
 {
 protected:
-	redisContext* context;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    bool engaged;
 
-    static const char* get_cmd(const char* func_name) {
-        return strrchr(func_name, ':') + 1;
+    T* ptr() { return reinterpret_cast<T*>(&storage); }
+    const T* ptr()const { return reinterpret_cast<const T*>(&storage); }
+public:
+    redis_optional_value() :engaged(false) {}
+    redis_optional_value(redis_nullopt_t) :engaged(false) {}
+    redis_optional_value(const T& _v) :engaged(true) { new (&storage) T(_v); }
+    redis_optional_value(T&& _v) :engaged(true) { new (&storage) T(std::move(_v)); }
+    redis_optional_value(const redis_optional_value& _v) :engaged(_v.engaged)
+    {
+        if (engaged) {
+            new (&storage) T(*_v);
+        }
     }
-
-	////////////////////////////////////////////////////////////////////////////////////////////
-    class redis_key
+    redis_optional_value(redis_optional_value&& _v) :engaged(_v.engaged)
     {
-    protected:
-        friend class redis_context;
-        redisContext* context;
+        if (engaged) {
+            new (&storage) T(std::move(*_v));
+        }
+    }
+    ~redis_optional_value() { reset(); }
 
-        redis_key(redisContext* _context) :context(_context) {
+    redis_optional_value& operator =(const redis_optional_value& _v)
+    {
+        if (this != &_v) {
+            _v.engaged ? (void)emplace(*_v) : reset();
         }
-    public:
-        int64_t DEL(const std::vector<std::string>& keys) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), keys);
+        return *this;
+    }
+    redis_optional_value& operator =(redis_optional_value&& _v)
+    {
+        if (this != &_v) {
+            _v.engaged ? (void)emplace(std::move(*_v)) : reset();
         }
+        return *this;
+    }
+    redis_optional_value& operator =(redis_nullopt_t)
+    {
+        reset();
+        return *this;
+    }
 
-        redis_optional<std::string> DUMP(const std::string& key)
-        {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key);
-
-            return _reply.is_nil() ? redis_nullopt : 
-                redis_make_optional((std::string)_reply);
+    template<typename... ARGS>
+    T& emplace(ARGS&&... _args)
+    {
+        reset();
+        new (&storage) T(std::forward<ARGS>(_args)...);
+        engaged = true;
+        return *ptr();
+    }
+    void reset()
+    {
+        if (engaged) {
+            ptr()->~T();
+            engaged = false;
         }
+    }
 
-        bool EXISTS(const std::string& key) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key) != 0;
-        }
+    bool has_value()const { return engaged; }
+    explicit operator bool()const { return engaged; }
 
-        bool EXPIRE(const std::string& key, int seconds) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, seconds) != 0;
-        }
+    T& operator *() { return *ptr(); }
+    const T& operator *()const { return *ptr(); }
+    T* operator ->() { return ptr(); }
+    const T* operator ->()const { return ptr(); }
 
-        bool EXPIREAT(const std::string& key, int timestamp) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, timestamp) != 0;
-        }
+    T& value()
+    {
+        redis_test(engaged, redis_error_code::reply_is_null);
+        return *ptr();
+    }
+    const T& value()const
+    {
+        redis_test(engaged, redis_error_code::reply_is_null);
+        return *ptr();
+    }
+    template<typename U>
+    T value_or(U&& _default)const
+    {
+        return engaged ? *ptr() : static_cast<T>(std::forward<U>(_default));
+    }
+};
 
-        std::vector<std::string> KEYS(const std::string& pattern) {
-            return (std::vector<std::string>)redis_reply(context, get_cmd(__FUNCTION__), pattern);
-        }
+template<typename T>
+redis_optional_value<typename std::decay<T>::type> redis_make_optional_value(T&& _v) {
+    return redis_optional_value<typename std::decay<T>::type>(std::forward<T>(_v));
+}
 
-        bool MIGRATE(const std::string& host, int port, const std::string& key, int destination_db, int timeout,
-            bool copy = false, bool replace = false)
-        {
-            std::vector<std::string> argv = {
-                host,
-                std::to_string(port),
-                key,
-                std::to_string(destination_db),
-                std::to_string(timeout)
-            };
-            if (copy) {
-                argv.push_back("COPY");
-            }
-            if (replace) {
-                argv.push_back("REPLACE");
-            }
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), argv);
-            return _reply.is_ok();
-        }
+#   define redis_optional redis_optional_value
+#   define redis_nullopt redis_nullopt_t()
+#   define redis_make_optional(v) redis_make_optional_value(v)
+#endif
 
-        bool MOVE(const std::string& key, int db) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, db) != 0;
-        }
 
-        enum { REFCOUNT };
-        int64_t OBJECT(decltype(REFCOUNT) /*REFCOUNT*/, const std::string& key) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), "REFCOUNT", key);
-        }
-        enum { ENCODING };
-        std::string OBJECT(decltype(ENCODING) /*ENCODING*/, const std::string& key) {
-            return (std::string)redis_reply(context, get_cmd(__FUNCTION__), "ENCODING", key);
-        }
-        enum { IDLETIME };
-        int64_t OBJECT(decltype(IDLETIME) /*IDLETIME*/, const std::string& key) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), "IDLETIME", key);
-        }
+template<typename T>
+class redis_convert
+{
+public:
+    typedef T result_type;
+    T operator ()(const redis_reply& _reply)const {
+        return (T)_reply;
+    }
+};
 
-        bool PERSIST(const std::string& key) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key) != 0;
-        }
+template<>
+class redis_convert<int32_t>
+{
+public:
+    typedef int32_t result_type;
+    int32_t operator ()(const redis_reply& _reply)const {
+        return (int32_t)(int64_t)_reply;
+    }
+};
 
-        bool PEXPIRE(const std::string& key, int64_t milliseconds) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, milliseconds) != 0;
-        }
+template<>
+class redis_convert<std::vector<redis_optional<std::string>>>
+{
+public:
+    typedef std::vector<redis_optional<std::string>> result_type;
+    result_type operator ()(const redis_reply& _reply)const
+    {
+        //ֱӴӻӦĻ,мredis_replystd::string
+        const redisReply* _raw = _reply;
+        result_type _v(_raw != nullptr && _raw->type == REDIS_REPLY_ARRAY ? _raw->elements : 0);
+        _reply.for_each_string([&](size_t i, const char* _str, size_t _len) {
+            _v[i].emplace(_str, _len);
+        });
+        return _v;
+    }
+};
 
-        bool PEXPIREAT(const std::string& key, int64_t milliseconds_timestamp) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, milliseconds_timestamp) != 0;
-        }
+template<>
+class redis_convert<std::pair<redis_optional<std::string>, std::string>>
+{
+public:
+    typedef std::pair<redis_optional<std::string>, std::string> result_type;
+    result_type operator ()(const redis_reply& _reply)const
+    {
+        auto p = (std::vector<redis_reply>)_reply;
 
-        int64_t PTTL(const std::string& key) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key);
-        }
+        return std::make_pair(
+            (p[0].is_nil() ? redis_nullopt : redis_make_optional((std::string)p[0])),
+            (std::string)p[1]);
+    }
+};
 
-        redis_optional<std::string> RANDOMKEY()
-        {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__));
+template<typename T>
+class redis_convert_optional
+{
+public:
+    typedef redis_optional<T> result_type;
+    result_type operator ()(const redis_reply& _reply)const
+    {
+        return _reply.is_nil() ? redis_nullopt :
+            redis_make_optional((T)_reply);
+    }
+};
 
-            return _reply.is_nil() ? redis_nullopt :
-                redis_make_optional((std::string)_reply);
-        }
+inline void redis_move_optionals(const redis_reply& _reply,
+    std::vector<redis_optional<std::string>>& _values, size_t _begin, size_t _end)
+{
+    auto _v = redis_convert<std::vector<redis_optional<std::string>>>()(_reply);
+    redis_test(_v.size() == _end - _begin, redis_error_code::reply_data_incorrect, _reply.get_cmd());
+    std::move(_v.begin(), _v.end(), _values.begin() + _begin);
+}
 
-        bool RENAME(const std::string& key, const std::string& newkey) {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key, newkey);
-            return _reply.is_ok();
-        }
+class redis_convert_ok
+{
+public:
+    typedef bool result_type;
+    bool operator ()(const redis_reply& _reply)const {
+        return _reply.is_ok();
+    }
+};
 
-        bool RENAMENX(const std::string& key, const std::string& newkey) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, newkey) != 0;
-        }
+class redis_convert_nonzero
+{
+public:
+    typedef bool result_type;
+    bool operator ()(const redis_reply& _reply)const {
+        return (int64_t)_reply != 0;
+    }
+};
 
-        bool RESTORE(const std::string& key, int64_t ttl, const std::string& serialized_value) 
-        {
-            std::vector<std::string> argv = {
-                key,
-                std::to_string(ttl),
-                serialized_value
-            };
-
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), argv);
-            return _reply.is_ok();
+class redis_convert_float
+{
+public:
+    typedef double result_type;
+    double operator ()(const redis_reply& _reply)const {
+        return (double)_reply;
+    }
+};
+
+class redis_convert_rank
+{
+public:
+    typedef int64_t result_type;
+    int64_t operator ()(const redis_reply& _reply)const {
+        return _reply.is_nil() ? -1 : (int64_t)_reply;
+    }
+};
+
+class redis_convert_member_map
+{
+public:
+    typedef std::map<std::string, std::string> result_type;
+    result_type operator ()(const redis_reply& _reply)const
+    {
+        std::map<std::string, std::string> _m;
+        for (auto& _member : (std::set<std::string>)_reply) {
+            _m[_member] = "0";
         }
+        return _m;
+    }
+};
 
-        std::vector<std::string> SORT(const std::string& key,
-            const std::string& by_pattern = "",
-            int limit_offset = 0, unsigned int limit_count = -1,
-            const std::vector<std::string>& get_pattern = {},
-            bool desc = false, bool alpha = false)
-        {
-            std::vector<std::string> argv = { key };
-            if (!by_pattern.empty()) {
-                argv.push_back("BY");
-                argv.push_back(by_pattern);
-            }
-            if (!(limit_offset == 0 && limit_count == -1)) {
-                argv.push_back("LIMIT");
-                argv.push_back(std::to_string(limit_offset));
-                argv.push_back(std::to_string(limit_count));
-            }
-            for (auto& p : get_pattern) {
-                argv.push_back("GET");
-                argv.push_back(p);
-            }
-            if (desc) {
-                argv.push_back("DESC");
-            }
-            if (alpha) {
-                argv.push_back("ALPHA");
+//򼯺ϵĳԱ,˳
+class redis_convert_scored
+{
+public:
+    typedef std::vector<redis_scored_member> result_type;
+    result_type operator ()(const redis_reply& _reply)const
+    {
+        result_type _v;
+        _reply.append_scored(_v);
+        return _v;
+    }
+};
+
+//򼯺ϵĳԱ,˳
+class redis_convert_members
+{
+public:
+    typedef std::vector<std::string> result_type;
+    result_type operator ()(const redis_reply& _reply)const
+    {
+        result_type _v;
+        _reply.append_strings(_v);
+        return _v;
+    }
+};
+
+//ĿID
+class redis_convert_stream_id
+{
+public:
+    typedef redis_stream_id result_type;
+    result_type operator ()(const redis_reply& _reply)const
+    {
+        std::string _text = (std::string)_reply;
+        redis_stream_id _id;
+        redis_test(redis_stream_id::parse(_text.data(), _text.size(), _id), redis_error_code::reply_data_incorrect, _reply.get_cmd());
+        return _id;
+    }
+};
+
+//Ŀ,˳
+class redis_convert_stream_entries
+{
+public:
+    typedef std::vector<redis_stream_entry> result_type;
+    result_type operator ()(const redis_reply& _reply)const
+    {
+        result_type _v;
+        _reply.append_stream_entries(_v);
+        return _v;
+    }
+};
+
+//XREAD/XREADGROUPĿ,ʱؿ
+class redis_convert_streams
+{
+public:
+    typedef std::vector<redis_stream_result> result_type;
+    result_type operator ()(const redis_reply& _reply)const
+    {
+        result_type _v;
+        _reply.append_streams(_v);
+        return _v;
+    }
+};
+
+//д÷ṩ,е,Ԫظ
+//ڽ֮ǰһֱЧ
+template<typename T>
+class redis_convert_into
+{
+protected:
+    T* out;
+
+    static void append(const redis_reply& _reply, std::vector<redis_scored_member>& _out) {
+        _reply.append_scored(_out);
+    }
+    static void append(const redis_reply& _reply, std::vector<std::string>& _out) {
+        _reply.append_strings(_out);
+    }
+public:
+    typedef size_t result_type;
+
+    redis_convert_into(T* _out) :out(_out) {}
+
+    size_t operator ()(const redis_reply& _reply)const
+    {
+        out->clear();
+        append(_reply, *out);
+        return out->size();
+    }
+};
+
+//hashֱӽ뵽ֶαĽṹ(redis_struct.h)
+//by_orderΪtrueʱֶα˳HMGETĻӦ,ֶHGETALLĻӦ
+template<typename T>
+class redis_convert_struct
+{
+protected:
+    bool by_order;
+public:
+    typedef T result_type;
+
+    redis_convert_struct(bool _by_order = false) :by_order(_by_order) {}
+
+    result_type operator ()(const redis_reply& _reply)const
+    {
+        T _v = T();
+        by_order ? redis_struct<T>::decode_values(_reply, _v) : redis_struct<T>::decode(_reply, _v);
+        return _v;
+    }
+};
+
+//뵽÷ṩĽṹ,ַԱе,Ƿ뵽κֶ
+//ṹڽ֮ǰһֱЧ
+template<typename T>
+class redis_convert_struct_into
+{
+protected:
+    T* out;
+    bool by_order;
+public:
+    typedef bool result_type;
+
+    redis_convert_struct_into(T* _out, bool _by_order = false) :out(_out), by_order(_by_order) {}
+
+    bool operator ()(const redis_reply& _reply)const
+    {
+        return (by_order ? redis_struct<T>::decode_values(_reply, *out) : redis_struct<T>::decode(_reply, *out)) > 0;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+//SCANϵȥ
+//SCANظͬһԪ,ȥõڴ_memory_budget(ֽ)
+//none:        ȥ,صյظԪ
+//exact:       Ĭ,std::setԪ,ȷ,ڴԪ,Ԥ
+//bloom:       ̶СĲ¡,ڴ̶,ʱ©δֹԪ
+//fingerprint: 64λָƵĿѰַ,ݵԤΪֹ,֮ټ¼Ԫ
+//             Ԫصָͬʱһᱻظ©,ʼ͵Ϊ
+class redis_scan_dedup
+{
+public:
+    enum mode { none, exact, bloom, fingerprint };
+protected:
+    mode type;
+    size_t memory_budget;
+    std::set<std::string> items;
+    std::vector<uint64_t> table;
+    size_t count;
+
+    static uint64_t hash(const std::string& _item)
+    {
+        uint64_t h = 14695981039346656037ULL;
+        for (unsigned char c : _item) {
+            h = (h ^ c) * 1099511628211ULL;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    //k=7,ʹ˫ɢеõλ
+    bool insert_bloom(uint64_t h)
+    {
+        if (table.empty()) {
+            table.resize(std::max<size_t>(memory_budget / sizeof(uint64_t), 1));
+        }
+        uint64_t _bits = (uint64_t)table.size() * 64;
+        uint64_t _h1 = h, _h2 = (h >> 32) | 1;
+        bool _new = false;
+        for (int i = 0; i < 7; i++) {
+            uint64_t _bit = (_h1 + i * _h2) % _bits;
+            uint64_t _mask = 1ULL << (_bit & 63);
+            if (!(table[_bit >> 6] & _mask)) {
+                table[_bit >> 6] |= _mask;
+                _new = true;
             }
-            return (std::vector<std::string>)redis_reply(context, get_cmd(__FUNCTION__), argv);
         }
+        return _new;
+    }
 
-        int64_t SORT(const std::string& key, const std::string& store,
-            const std::string& by_pattern = "",
-            int limit_offset = 0, unsigned int limit_count = -1,
-            const std::vector<std::string>& get_pattern = {},
-            bool desc = false, bool alpha = false)
-        {
-            std::vector<std::string> argv = { key };
-            if (!by_pattern.empty()) {
-                argv.push_back("BY");
-                argv.push_back(by_pattern);
-            }
-            if (!(limit_offset == 0 && limit_count == -1)) {
-                argv.push_back("LIMIT");
-                argv.push_back(std::to_string(limit_offset));
-                argv.push_back(std::to_string(limit_count));
+    //0ʾղ,̽
+    static bool probe(std::vector<uint64_t>& _table, uint64_t h)
+    {
+        size_t _mask = _table.size() - 1;
+        for (size_t i = (size_t)h & _mask;; i = (i + 1) & _mask) {
+            if (_table[i] == h) {
+                return false;
             }
-            for (auto& p : get_pattern) {
-                argv.push_back("GET");
-                argv.push_back(p);
+            if (_table[i] == 0) {
+                _table[i] = h;
+                return true;
             }
-            if (desc) {
-                argv.push_back("DESC");
+        }
+    }
+
+    bool insert_fingerprint(uint64_t h)
+    {
+        h = h ? h : 1;
+        if (table.empty()) {
+            table.resize(1024);
+        }
+        if ((count + 1) * 4 > table.size() * 3) {
+            if (table.size() * 2 * sizeof(uint64_t) > memory_budget) {
+                //ﵽԤֻ鲻
+                size_t _mask = table.size() - 1;
+                for (size_t i = (size_t)h & _mask; table[i] != 0; i = (i + 1) & _mask) {
+                    if (table[i] == h) {
+                        return false;
+                    }
+                }
+                return true;
             }
-            if (alpha) {
-                argv.push_back("ALPHA");
+            std::vector<uint64_t> _table(table.size() * 2);
+            for (auto _h : table) {
+                if (_h != 0) {
+                    probe(_table, _h);
+                }
             }
-            argv.push_back("STORE");
-            argv.push_back(store);
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv);
+            table.swap(_table);
         }
+        if (probe(table, h)) {
+            count++;
+            return true;
+        }
+        return false;
+    }
+public:
+    redis_scan_dedup(mode _type = exact, size_t _memory_budget = 64 * 1024 * 1024) :
+        type(_type), memory_budget(_memory_budget), count(0)
+    {
+    }
 
-        int32_t TTL(const std::string& key) {
-            return (int32_t)(int64_t)redis_reply(context, get_cmd(__FUNCTION__), key);
+    //һγַtrue
+    bool insert(const std::string& _item)
+    {
+        switch (type) {
+        case none:
+            return true;
+        case exact:
+            return items.insert(_item).second;
+        case bloom:
+            return insert_bloom(hash(_item));
+        default:
+            return insert_fingerprint(hash(_item));
         }
+    }
+};
 
-        std::string TYPE(const std::string& key) {
-            return (std::string)redis_reply(context, get_cmd(__FUNCTION__), key);
+////////////////////////////////////////////////////////////////////////////////////////////
+class redis_facade
+{
+protected:
+    static const char* get_cmd(const char* func_name) {
+        const char* p = strrchr(func_name, ':');
+        return p ? p + 1 : func_name;
+    }
+};
+
+class redis_context_driver
+{
+protected:
+    redisContext* context;
+    redis_tracer* tracer;
+public:
+    template<typename T> using result = T;
+
+    redis_context_driver(redisContext* _context, redis_tracer* _tracer = nullptr) :context(_context), tracer(_tracer) {
+    }
+
+    //tracerʱbegin/end¼,ıֻڲʱȾ
+    template<typename CONVERT, typename... ARGS>
+    typename CONVERT::result_type command(const CONVERT& _convert, const std::string& _cmd, ARGS&&... _args) {
+        if (tracer == nullptr) {
+            return _convert(redis_reply(context, _cmd, std::forward<ARGS>(_args)...));
         }
+        redis_trace_scope _trace(tracer, _cmd, _args...);
+        redis_reply _reply(context, _cmd, _args...);
+        _trace.end(_reply, [&]() { return redis_command_render(_cmd, _args...); });
+        return _convert(std::move(_reply));
+    }
+
+    //ִͬһ,ͬһ_window;
+    //_build(begin, end, argv)˳[begin, end)һĲ
+    //_on_reply(begin, end, reply)˳ÿһĻӦ
+    template<typename BUILD, typename ON_REPLY>
+    void chunked(const std::string& _cmd, size_t _count, size_t _chunk_size,
+        BUILD _build, ON_REPLY _on_reply, size_t _window = 4)
+    {
+        redis_test(_chunk_size > 0 && _window > 0);
 
-        void SCAN(const std::string& match = "*", int count = 10,
-            std::function<bool(const std::string&)> cb = [](const std::string& /*key*/) { return true; })
+        struct chunk {
+            size_t begin;
+            size_t end;
+            std::string cmd;
+        };
+        std::deque<chunk> _inflight;
+        redis_command_args _argv;
+        size_t _next = 0;
+
+        try
         {
-            int64_t _pos = 0;
-            std::set<std::string> _keys;
-            do
+            while (_next < _count || !_inflight.empty())
             {
-                auto _pair = (std::pair<tc_redis::redis_value, std::vector<std::string>>)
-                    redis_reply(context, get_cmd(__FUNCTION__), _pos, "MATCH", match, "COUNT", count);
-
-                _pos = _pair.first.as_int();
+                while (_next < _count && _inflight.size() < _window) {
+                    chunk _chunk = { _next, std::min(_count, _next + _chunk_size) };
+                    _argv.clear();
+                    _build(_chunk.begin, _chunk.end, _argv);
+                    _chunk.cmd = redis_append_command(context, _cmd, _argv);
+                    _next = _chunk.end;
+                    _inflight.push_back(std::move(_chunk));
+                }
 
-                for (auto& _key : _pair.second) {
-                    if (_keys.insert(_key).second) {
-                        if (!cb(_key)) {
-                            break;
-                        }
-                    }
+                chunk _chunk = std::move(_inflight.front());
+                _inflight.pop_front();
+                redis_reply _reply = redis_get_reply(context, _chunk.cmd);
+                _on_reply(_chunk.begin, _chunk.end, _reply);
+            }
+        }
+        catch (...)
+        {
+            //;ĻӦ,ӿ
+            for (auto& _chunk : _inflight) {
+                redisReply* _reply = nullptr;
+                if (redisGetReply(context, (void**)&_reply) != REDIS_OK) {
+                    break;
                 }
+                redis_reply_arena::free_reply(context, _reply);
+            }
+            throw;
+        }
+    }
+};
 
-            } while (_pos);
+//жǷͬؽ(redis_context,Ⱥ),SCANϵеαѭֻ
+template<typename DRIVER>
+class is_redis_sync_driver {
+public:
+    enum { value = std::is_same<typename DRIVER::template result<int>, int>::value };
+};
 
-        }
-    };
-    ////////////////////////////////////////////////////////////////////////////////////////////
-    class redis_string 
+//жǷǼȺ,ûkeySCANڼȺֻɨһڵ
+template<typename DRIVER>
+class is_redis_cluster_driver {
+public:
+    enum { value = false };
+};
+
+//жǷִַ֧(chunked),MGET/MSET/HMGET/HMSETֻ
+template<typename DRIVER, typename = void>
+class is_redis_chunked_driver {
+public:
+    enum { value = false };
+};
+
+template<typename DRIVER>
+class is_redis_chunked_driver<DRIVER, decltype(std::declval<DRIVER&>().chunked(std::declval<const std::string&>(), size_t(), size_t(),
+    std::declval<void(*)(size_t, size_t, redis_command_args&)>(), std::declval<void(*)(size_t, size_t, const redis_reply&)>()))> {
+public:
+    enum { value = true };
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+template<typename DRIVER>
+class redis_key : public redis_facade
+{
+protected:
+    DRIVER driver;
+
+    template<typename T> using result = typename DRIVER::template result<T>;
+public:
+    redis_key(const DRIVER& _driver) :driver(_driver) {
+    }
+
+    result<int64_t> DEL(const std::vector<std::string>& keys) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), keys);
+    }
+
+    //keysԪΪֵַ(std::vector<std::string_view>,std::span,std::list)
+    //ֱӴڴд,key
+    template<typename RANGE, typename std::enable_if<is_redis_arg_container<RANGE>::value, int>::type = 0>
+    result<int64_t> DEL(const RANGE& keys) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), redis_args(keys));
+    }
+
+    result<redis_optional<std::string>> DUMP(const std::string& key)
     {
-    protected:
-        friend class redis_context;
-        redisContext* context;
+        return driver.command(redis_convert_optional<std::string>(), get_cmd(__FUNCTION__), key);
+    }
 
-        redis_string(redisContext* _context) :context(_context) {
-        }
-    public:
-        int64_t APPEND(const std::string& key, const std::string& value) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, value);
-        }
+    result<bool> EXISTS(const std::string& key) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), key);
+    }
 
-        int64_t BITCOUNT(const std::string& key, int start = 0, int end = -1) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, start, end);
-        }
+    result<bool> EXPIRE(const std::string& key, int seconds) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), key, seconds);
+    }
 
-        enum { AND };
-        int64_t BITOP(decltype(AND) /*AND*/, const std::string& destkey, const std::vector<std::string>& keys)
-        {
-            std::vector<std::string> argv = { "AND" , destkey };
-            argv.insert(argv.end(), keys.begin(), keys.end());
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv);
+    result<bool> EXPIREAT(const std::string& key, int timestamp) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), key, timestamp);
+    }
+
+    result<std::vector<std::string>> KEYS(const std::string& pattern) {
+        return driver.command(redis_convert<std::vector<std::string>>(), get_cmd(__FUNCTION__), pattern);
+    }
+
+    result<bool> MIGRATE(const std::string& host, int port, const std::string& key, int destination_db, int timeout,
+        bool copy = false, bool replace = false)
+    {
+        redis_command_args argv;
+        argv.push_back(host);
+        argv.push_back(port);
+        argv.push_back(key);
+        argv.push_back(destination_db);
+        argv.push_back(timeout);
+        if (copy) {
+            argv.push_back("COPY");
+        }
+        if (replace) {
+            argv.push_back("REPLACE");
+        }
+        return driver.command(redis_convert_ok(), get_cmd(__FUNCTION__), argv);
+    }
+
+    result<bool> MOVE(const std::string& key, int db) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), key, db);
+    }
+
+    enum { REFCOUNT };
+    result<int64_t> OBJECT(decltype(REFCOUNT) /*REFCOUNT*/, const std::string& key) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), "REFCOUNT", key);
+    }
+    enum { ENCODING };
+    result<std::string> OBJECT(decltype(ENCODING) /*ENCODING*/, const std::string& key) {
+        return driver.command(redis_convert<std::string>(), get_cmd(__FUNCTION__), "ENCODING", key);
+    }
+    enum { IDLETIME };
+    result<int64_t> OBJECT(decltype(IDLETIME) /*IDLETIME*/, const std::string& key) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), "IDLETIME", key);
+    }
+
+    result<bool> PERSIST(const std::string& key) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), key);
+    }
+
+    result<bool> PEXPIRE(const std::string& key, int64_t milliseconds) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), key, milliseconds);
+    }
+
+    result<bool> PEXPIREAT(const std::string& key, int64_t milliseconds_timestamp) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), key, milliseconds_timestamp);
+    }
+
+    result<int64_t> PTTL(const std::string& key) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key);
+    }
+
+    result<redis_optional<std::string>> RANDOMKEY()
+    {
+        return driver.command(redis_convert_optional<std::string>(), get_cmd(__FUNCTION__));
+    }
+
+    result<bool> RENAME(const std::string& key, const std::string& newkey) {
+        return driver.command(redis_convert_ok(), get_cmd(__FUNCTION__), key, newkey);
+    }
+
+    result<bool> RENAMENX(const std::string& key, const std::string& newkey) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), key, newkey);
+    }
+
+    result<bool> RESTORE(const std::string& key, int64_t ttl, const std::string& serialized_value) 
+    {
+        return driver.command(redis_convert_ok(), get_cmd(__FUNCTION__), key, ttl, serialized_value);
+    }
+
+    result<std::vector<std::string>> SORT(const std::string& key,
+        const std::string& by_pattern = "",
+        int limit_offset = 0, unsigned int limit_count = -1,
+        const std::vector<std::string>& get_pattern = {},
+        bool desc = false, bool alpha = false)
+    {
+        redis_command_args argv;
+        argv.push_back(key);
+        if (!by_pattern.empty()) {
+            argv.push_back("BY");
+            argv.push_back(by_pattern);
         }
-        enum { OR };
-        int64_t BITOP(decltype(OR) /*OR*/, const std::string& destkey, const std::vector<std::string>& keys)
-        {
-            std::vector<std::string> argv = { "OR" , destkey };
-            argv.insert(argv.end(), keys.begin(), keys.end());
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv);
+        if (!(limit_offset == 0 && limit_count == -1)) {
+            argv.push_back("LIMIT");
+            argv.push_back(limit_offset);
+            argv.push_back(limit_count);
         }
-        enum { NOT };
-        int64_t BITOP(decltype(NOT) /*NOT*/, const std::string& destkey, const std::string& key) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), "NOT", destkey, key);
+        for (auto& p : get_pattern) {
+            argv.push_back("GET");
+            argv.push_back(p);
         }
-        enum { XOR };
-        int64_t BITOP(decltype(XOR) /*XOR*/, const std::string& destkey, const std::vector<std::string>& keys)
-        {
-            std::vector<std::string> argv = { "XOR" , destkey };
-            argv.insert(argv.end(), keys.begin(), keys.end());
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv);
+        if (desc) {
+            argv.push_back("DESC");
         }
+        if (alpha) {
+            argv.push_back("ALPHA");
+        }
+        return driver.command(redis_convert<std::vector<std::string>>(), get_cmd(__FUNCTION__), argv);
+    }
 
+    result<int64_t> SORT(const std::string& key, const std::string& store,
+        const std::string& by_pattern = "",
+        int limit_offset = 0, unsigned int limit_count = -1,
+        const std::vector<std::string>& get_pattern = {},
+        bool desc = false, bool alpha = false)
+    {
+        redis_command_args argv;
+        argv.push_back(key);
+        if (!by_pattern.empty()) {
+            argv.push_back("BY");
+            argv.push_back(by_pattern);
+        }
+        if (!(limit_offset == 0 && limit_count == -1)) {
+            argv.push_back("LIMIT");
+            argv.push_back(limit_offset);
+            argv.push_back(limit_count);
+        }
+        for (auto& p : get_pattern) {
+            argv.push_back("GET");
+            argv.push_back(p);
+        }
+        if (desc) {
+            argv.push_back("DESC");
+        }
+        if (alpha) {
+            argv.push_back("ALPHA");
+        }
+        argv.push_back("STORE");
+        argv.push_back(store);
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), argv);
+    }
 
+    result<int32_t> TTL(const std::string& key) {
+        return driver.command(redis_convert<int32_t>(), get_cmd(__FUNCTION__), key);
+    }
 
-        int64_t DECR(const std::string& key) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key);
-        }
-
-        int64_t DECRBY(const std::string& key, int64_t decrement) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, decrement);
-        }
+    result<std::string> TYPE(const std::string& key) {
+        return driver.command(redis_convert<std::string>(), get_cmd(__FUNCTION__), key);
+    }
 
-        redis_optional<std::string> GET(const std::string& key)
+    //cbfalseʱɨ
+    template<typename D = DRIVER, typename std::enable_if<is_redis_sync_driver<D>::value, int>::type = 0>
+    void SCAN(const std::string& match = "*", int count = 10,
+        std::function<bool(const std::string&)> cb = [](const std::string& /*key*/) { return true; },
+        redis_scan_dedup dedup = redis_scan_dedup())
+    {
+        static_assert(!is_redis_cluster_driver<D>::value,
+            "SCAN on a cluster only covers one master, use redis_parallel_scan(cluster.scan_sources())");
+        int64_t _pos = 0;
+        do
         {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key);
+            auto _pair = driver.command(redis_convert<std::pair<tc_redis::redis_value, std::vector<std::string>>>(),
+                get_cmd(__FUNCTION__), _pos, "MATCH", match, "COUNT", count);
 
-            return _reply.is_nil() ? redis_nullopt :
-                redis_make_optional((std::string)_reply);
-        }
+            _pos = _pair.first.as_int();
 
-        bool GETBIT(const std::string& key, int offset) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, offset) != 0;
-        }
+            for (auto& _key : _pair.second) {
+                if (dedup.insert(_key) && !cb(_key)) {
+                    return;
+                }
+            }
 
-        std::string GETRANGE(const std::string& key, int start = 0, int end = -1) {
-            return (std::string)redis_reply(context, get_cmd(__FUNCTION__), key, start, end);
-        }
+        } while (_pos);
 
-        std::string GETSET(const std::string& key, const std::string& value) {
-            return (std::string)redis_reply(context, get_cmd(__FUNCTION__), key, value);
-        }
+    }
+};
+////////////////////////////////////////////////////////////////////////////////////////////
+template<typename DRIVER>
+class redis_string : public redis_facade
+{
+protected:
+    DRIVER driver;
 
-        int64_t INCR(const std::string& key) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key);
-        }
+    template<typename T> using result = typename DRIVER::template result<T>;
+public:
+    redis_string(const DRIVER& _driver) :driver(_driver) {
+    }
 
-        int64_t INCRBY(const std::string& key, int64_t increment) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, increment);
-        }
+    result<int64_t> APPEND(const std::string& key, const std::string& value) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, value);
+    }
 
-        double INCRBYFLOAT(const std::string& key, double increment) {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key, increment);
-            return ((redis_value)_reply).as_float();
-        }
+    result<int64_t> BITCOUNT(const std::string& key, int start = 0, int end = -1) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, start, end);
+    }
 
-        std::vector<redis_optional<std::string>> MGET(const std::vector<std::string>& keys) {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), keys);
-            std::vector<redis_optional<std::string>> _v;
-            for (auto& _r : (std::vector<redis_reply>)_reply) {
-                _v.emplace_back(
-                    _r.is_nil() ? redis_nullopt :
-                    redis_make_optional((std::string)_r));
-            }
-            return _v;
-        }
+    enum { AND };
+    result<int64_t> BITOP(decltype(AND) /*AND*/, const std::string& destkey, const std::vector<std::string>& keys)
+    {
+        redis_command_args argv;
+        argv.push_back("AND");
+        argv.push_back(destkey);
+        argv.append(keys.begin(), keys.end());
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), argv);
+    }
+    enum { OR };
+    result<int64_t> BITOP(decltype(OR) /*OR*/, const std::string& destkey, const std::vector<std::string>& keys)
+    {
+        redis_command_args argv;
+        argv.push_back("OR");
+        argv.push_back(destkey);
+        argv.append(keys.begin(), keys.end());
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), argv);
+    }
+    enum { NOT };
+    result<int64_t> BITOP(decltype(NOT) /*NOT*/, const std::string& destkey, const std::string& key) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), "NOT", destkey, key);
+    }
+    enum { XOR };
+    result<int64_t> BITOP(decltype(XOR) /*XOR*/, const std::string& destkey, const std::vector<std::string>& keys)
+    {
+        redis_command_args argv;
+        argv.push_back("XOR");
+        argv.push_back(destkey);
+        argv.append(keys.begin(), keys.end());
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), argv);
+    }
 
-        bool MSET(const std::map<std::string, std::string>& key_value_pairs) 
-        {
-            std::vector<std::string> argv;
-            for (auto& p : key_value_pairs) {
-                argv.push_back(p.first);
-                argv.push_back(p.second);
-            }
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), argv);
-            return _reply.is_ok();
-        }
 
-        bool MSETNX(const std::map<std::string, std::string>& key_value_pairs)
-        {
-            std::vector<std::string> argv;
-            for (auto& p : key_value_pairs) {
-                argv.push_back(p.first);
-                argv.push_back(p.second);
-            }
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv) != 0;
-        }
 
-        bool PSETEX(const std::string& key, int64_t milliseconds, const std::string& value) {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key, milliseconds, value);
-            return _reply.is_ok();
-        }
+    result<int64_t> DECR(const std::string& key) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key);
+    }
 
-        bool SET(const std::string& key, const std::string& value, int seconds = -1, bool nx = false, bool xx = false)
-        {
-            std::vector<std::string> argv = { key, value };
-            if (seconds != -1) {
-                argv.push_back("EX");
-                argv.push_back(std::to_string(seconds));
-            }
-            redis_test(!(nx && xx));
-            if (nx) {
-                argv.push_back("NX");
-            }
-            if (xx) {
-                argv.push_back("XX");
-            }
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), argv);
-            return _reply.is_ok();
-        }
+    result<int64_t> DECRBY(const std::string& key, int64_t decrement) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, decrement);
+    }
 
-        bool SET(const std::string& key, const std::string& value, int64_t milliseconds /*= -1*/, bool nx = false, bool xx = false)
-        {
-            std::vector<std::string> argv = { key, value };
-            if (milliseconds != -1) {
-                argv.push_back("PX");
-                argv.push_back(std::to_string(milliseconds));
-            }
-            redis_test(!(nx && xx));
-            if (nx) {
-                argv.push_back("NX");
-            }
-            if (xx) {
-                argv.push_back("XX");
-            }
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), argv);
-            return _reply.is_ok();
-        }
+    result<redis_optional<std::string>> GET(const std::string& key)
+    {
+        return driver.command(redis_convert_optional<std::string>(), get_cmd(__FUNCTION__), key);
+    }
 
-        bool SETBIT(const std::string& key, int offset, bool value) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, offset, value) != 0;
-        }
+    result<bool> GETBIT(const std::string& key, int offset) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), key, offset);
+    }
 
-        bool SETEX(const std::string& key, int seconds, const std::string& value) {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key, seconds, value);
-            return _reply.is_ok();
-        }
+    result<std::string> GETRANGE(const std::string& key, int start = 0, int end = -1) {
+        return driver.command(redis_convert<std::string>(), get_cmd(__FUNCTION__), key, start, end);
+    }
 
-        bool SETNX(const std::string& key, const std::string& value) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, value) != 0;
-        }
+    result<std::string> GETSET(const std::string& key, const std::string& value) {
+        return driver.command(redis_convert<std::string>(), get_cmd(__FUNCTION__), key, value);
+    }
 
-        int64_t SETRANGE(const std::string& key, int offset, const std::string& value) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, offset, value);
-        }
+    result<int64_t> INCR(const std::string& key) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key);
+    }
 
-        int64_t STRLEN(const std::string& key) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key);
-        }
-    };
-    ////////////////////////////////////////////////////////////////////////////////////////////
-    class redis_hash
+    result<int64_t> INCRBY(const std::string& key, int64_t increment) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, increment);
+    }
+
+    result<double> INCRBYFLOAT(const std::string& key, double increment) {
+        return driver.command(redis_convert_float(), get_cmd(__FUNCTION__), key, increment);
+    }
+
+    result<std::vector<redis_optional<std::string>>> MGET(const std::vector<std::string>& keys) {
+        return driver.command(redis_convert<std::vector<redis_optional<std::string>>>(), get_cmd(__FUNCTION__), keys);
+    }
+
+    template<typename RANGE, typename std::enable_if<is_redis_arg_container<RANGE>::value, int>::type = 0>
+    result<std::vector<redis_optional<std::string>>> MGET(const RANGE& keys) {
+        return driver.command(redis_convert<std::vector<redis_optional<std::string>>>(), get_cmd(__FUNCTION__), redis_args(keys));
+    }
+
+    //ÿchunk_sizekeyһMGET,ˮ߷,˳дvalues
+    template<typename D = DRIVER, typename std::enable_if<is_redis_chunked_driver<D>::value, int>::type = 0>
+    void MGET(const std::vector<std::string>& keys, std::vector<redis_optional<std::string>>& values, size_t chunk_size)
     {
-    protected:
-        friend class redis_context;
-        redisContext* context;
+        values.resize(keys.size());
+        driver.chunked(get_cmd(__FUNCTION__), keys.size(), chunk_size,
+            [&](size_t _begin, size_t _end, redis_command_args& argv) {
+                argv.append(keys.begin() + _begin, keys.begin() + _end);
+            },
+            [&](size_t _begin, size_t _end, const redis_reply& _reply) {
+                redis_move_optionals(_reply, values, _begin, _end);
+            });
+    }
 
-        redis_hash(redisContext* _context) :context(_context) {
-        }
-    public:
-        int64_t HDEL(const std::string& key, const std::vector<std::string>& fields)
-        {
-            std::vector<std::string> argv = { key };
-            argv.insert(argv.end(), fields.begin(), fields.end());
+    result<bool> MSET(const std::map<std::string, std::string>& key_value_pairs) {
+        return driver.command(redis_convert_ok(), get_cmd(__FUNCTION__), redis_pairs(key_value_pairs));
+    }
 
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv);
-        }
+    //key_value_pairsԪΪpair(std::unordered_map,std::vector<std::pair<...>>),Ҫ
+    template<typename RANGE, typename std::enable_if<is_redis_pair_container<RANGE>::value, int>::type = 0>
+    result<bool> MSET(const RANGE& key_value_pairs) {
+        return driver.command(redis_convert_ok(), get_cmd(__FUNCTION__), redis_pairs(key_value_pairs));
+    }
 
-        bool HEXISTS(const std::string& key, const std::string& field) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, field) != 0;
-        }
-            
-        redis_optional<std::string> HGET(const std::string& key, const std::string& field)
-        {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key, field);
+    template<typename D = DRIVER, typename std::enable_if<is_redis_chunked_driver<D>::value, int>::type = 0>
+    bool MSET(const std::map<std::string, std::string>& key_value_pairs, size_t chunk_size)
+    {
+        bool _ok = true;
+        auto _it = key_value_pairs.begin();
+        driver.chunked(get_cmd(__FUNCTION__), key_value_pairs.size(), chunk_size,
+            [&](size_t _begin, size_t _end, redis_command_args& argv) {
+                for (; _begin < _end; ++_begin, ++_it) {
+                    argv.push_back(_it->first);
+                    argv.push_back(_it->second);
+                }
+            },
+            [&](size_t, size_t, const redis_reply& _reply) {
+                _ok = _reply.is_ok() && _ok;
+            });
+        return _ok;
+    }
 
-            return _reply.is_nil() ? redis_nullopt :
-                redis_make_optional((std::string)_reply);
-        }
+    result<bool> MSETNX(const std::map<std::string, std::string>& key_value_pairs) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), redis_pairs(key_value_pairs));
+    }
 
-        std::map<std::string, std::string> HGETALL(const std::string& key) {
-            return (std::map<std::string, std::string>)redis_reply(context, get_cmd(__FUNCTION__), key);
-        }
-            
-        int64_t HINCRBY(const std::string& key, const std::string& field, int64_t increment) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, field, increment);
-        }
+    template<typename RANGE, typename std::enable_if<is_redis_pair_container<RANGE>::value, int>::type = 0>
+    result<bool> MSETNX(const RANGE& key_value_pairs) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), redis_pairs(key_value_pairs));
+    }
 
-        double HINCRBYFLOAT(const std::string& key, const std::string& field, double increment) {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key, field, increment);
-            return ((redis_value)_reply).as_float();
-        }
+    //ֻ֤ÿһڵԭ,óɹŷtrue
+    template<typename D = DRIVER, typename std::enable_if<is_redis_chunked_driver<D>::value, int>::type = 0>
+    bool MSETNX(const std::map<std::string, std::string>& key_value_pairs, size_t chunk_size)
+    {
+        bool _set = true;
+        auto _it = key_value_pairs.begin();
+        driver.chunked(get_cmd(__FUNCTION__), key_value_pairs.size(), chunk_size,
+            [&](size_t _begin, size_t _end, redis_command_args& argv) {
+                for (; _begin < _end; ++_begin, ++_it) {
+                    argv.push_back(_it->first);
+                    argv.push_back(_it->second);
+                }
+            },
+            [&](size_t, size_t, const redis_reply& _reply) {
+                _set = (int64_t)_reply != 0 && _set;
+            });
+        return _set;
+    }
 
-        std::vector<std::string> HKEYS(const std::string& key) {
-            return (std::vector<std::string>)redis_reply(context, get_cmd(__FUNCTION__), key);
-        }
+    result<bool> PSETEX(const std::string& key, int64_t milliseconds, const std::string& value) {
+        return driver.command(redis_convert_ok(), get_cmd(__FUNCTION__), key, milliseconds, value);
+    }
 
-        int64_t HLEN(const std::string& key) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key);
+    result<bool> SET(const std::string& key, const std::string& value, int seconds = -1, bool nx = false, bool xx = false)
+    {
+        redis_command_args argv;
+        argv.push_back(key);
+        argv.push_back(value);
+        if (seconds != -1) {
+            argv.push_back("EX");
+            argv.push_back(seconds);
         }
-
-        std::vector<redis_optional<std::string>> HMGET(const std::string& key, const std::vector<std::string>& fields)
-        {
-            std::vector<std::string> argv = { key };
-            argv.insert(argv.end(), fields.begin(), fields.end());
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), argv);
-            std::vector<redis_optional<std::string>> _v;
-            for (auto& _r : (std::vector<redis_reply>)_reply) {
-                _v.emplace_back(
-                    _r.is_nil() ? redis_nullopt :
-                    redis_make_optional((std::string)_r));
-            }
-            return _v;
+        redis_test(!(nx && xx));
+        if (nx) {
+            argv.push_back("NX");
         }
-
-        bool HMSET(const std::string& key, const std::map<std::string, std::string>& field_value_pairs) 
-        {
-            std::vector<std::string> argv = { key };
-            for (auto& p : field_value_pairs) {
-                argv.push_back(p.first);
-                argv.push_back(p.second);
-            }
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), argv);
-            return _reply.is_ok();
+        if (xx) {
+            argv.push_back("XX");
         }
+        return driver.command(redis_convert_ok(), get_cmd(__FUNCTION__), argv);
+    }
 
-        bool HSET(const std::string& key, const std::string& field, const std::string& value) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, field, value) != 0;
+    result<bool> SET(const std::string& key, const std::string& value, int64_t milliseconds /*= -1*/, bool nx = false, bool xx = false)
+    {
+        redis_command_args argv;
+        argv.push_back(key);
+        argv.push_back(value);
+        if (milliseconds != -1) {
+            argv.push_back("PX");
+            argv.push_back(milliseconds);
         }
-
-        bool HSETNX(const std::string& key, const std::string& field, const std::string& value) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, field, value) != 0;
+        redis_test(!(nx && xx));
+        if (nx) {
+            argv.push_back("NX");
         }
-            
-        std::vector<std::string> HVALS(const std::string& key) {
-            return (std::vector<std::string>)redis_reply(context, get_cmd(__FUNCTION__), key);
+        if (xx) {
+            argv.push_back("XX");
         }
-            
-        void HSCAN(const std::string& key, const std::string& match = "*", int count = 10,
-            std::function<bool(const std::string&, const std::string&)> cb =
-            [](const std::string& /*field*/, const std::string& /*value*/) { return true; })
+        return driver.command(redis_convert_ok(), get_cmd(__FUNCTION__), argv);
+    }
+
+    result<bool> SETBIT(const std::string& key, int offset, bool value) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), key, offset, value);
+    }
+
+    result<bool> SETEX(const std::string& key, int seconds, const std::string& value) {
+        return driver.command(redis_convert_ok(), get_cmd(__FUNCTION__), key, seconds, value);
+    }
+
+    result<bool> SETNX(const std::string& key, const std::string& value) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), key, value);
+    }
+
+    result<int64_t> SETRANGE(const std::string& key, int offset, const std::string& value) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, offset, value);
+    }
+
+    result<int64_t> STRLEN(const std::string& key) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key);
+    }
+};
+////////////////////////////////////////////////////////////////////////////////////////////
+template<typename DRIVER>
+class redis_hash : public redis_facade
+{
+protected:
+    DRIVER driver;
+
+    template<typename T> using result = typename DRIVER::template result<T>;
+public:
+    redis_hash(const DRIVER& _driver) :driver(_driver) {
+    }
+
+    result<int64_t> HDEL(const std::string& key, const std::vector<std::string>& fields) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, redis_args(fields));
+    }
+
+    template<typename RANGE, typename std::enable_if<is_redis_arg_container<RANGE>::value, int>::type = 0>
+    result<int64_t> HDEL(const std::string& key, const RANGE& fields) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, redis_args(fields));
+    }
+
+    result<bool> HEXISTS(const std::string& key, const std::string& field) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), key, field);
+    }
+        
+    result<redis_optional<std::string>> HGET(const std::string& key, const std::string& field)
+    {
+        return driver.command(redis_convert_optional<std::string>(), get_cmd(__FUNCTION__), key, field);
+    }
+
+    result<std::map<std::string, std::string>> HGETALL(const std::string& key) {
+        return driver.command(redis_convert<std::map<std::string, std::string>>(), get_cmd(__FUNCTION__), key);
+    }
+
+    //뵽ṹ,hashʱĬϹĽṹ
+    template<typename T, typename = typename std::enable_if<is_redis_struct<T>::value>::type>
+    result<T> HGETALL(const std::string& key) {
+        return driver.command(redis_convert_struct<T>(), get_cmd(__FUNCTION__), key);
+    }
+
+    //뵽value,ֻhashдڵֶ,hashʱfalse
+    template<typename T, typename = typename std::enable_if<is_redis_struct<T>::value>::type>
+    result<bool> HGETALL(const std::string& key, T& value) {
+        return driver.command(redis_convert_struct_into<T>(&value), get_cmd(__FUNCTION__), key);
+    }
+        
+    result<int64_t> HINCRBY(const std::string& key, const std::string& field, int64_t increment) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, field, increment);
+    }
+
+    result<double> HINCRBYFLOAT(const std::string& key, const std::string& field, double increment) {
+        return driver.command(redis_convert_float(), get_cmd(__FUNCTION__), key, field, increment);
+    }
+
+    result<std::vector<std::string>> HKEYS(const std::string& key) {
+        return driver.command(redis_convert<std::vector<std::string>>(), get_cmd(__FUNCTION__), key);
+    }
+
+    result<int64_t> HLEN(const std::string& key) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key);
+    }
+
+    result<std::vector<redis_optional<std::string>>> HMGET(const std::string& key, const std::vector<std::string>& fields) {
+        return driver.command(redis_convert<std::vector<redis_optional<std::string>>>(), get_cmd(__FUNCTION__), key, redis_args(fields));
+    }
+
+    template<typename RANGE, typename std::enable_if<is_redis_arg_container<RANGE>::value, int>::type = 0>
+    result<std::vector<redis_optional<std::string>>> HMGET(const std::string& key, const RANGE& fields) {
+        return driver.command(redis_convert<std::vector<redis_optional<std::string>>>(), get_cmd(__FUNCTION__), key, redis_args(fields));
+    }
+
+    template<typename D = DRIVER, typename std::enable_if<is_redis_chunked_driver<D>::value, int>::type = 0>
+    void HMGET(const std::string& key, const std::vector<std::string>& fields,
+        std::vector<redis_optional<std::string>>& values, size_t chunk_size)
+    {
+        values.resize(fields.size());
+        driver.chunked(get_cmd(__FUNCTION__), fields.size(), chunk_size,
+            [&](size_t _begin, size_t _end, redis_command_args& argv) {
+                argv.push_back(key);
+                argv.append(fields.begin() + _begin, fields.begin() + _end);
+            },
+            [&](size_t _begin, size_t _end, const redis_reply& _reply) {
+                redis_move_optionals(_reply, values, _begin, _end);
+            });
+    }
+
+    //ȡṹֶ,ڵֶαĬֵ
+    template<typename T, typename = typename std::enable_if<is_redis_struct<T>::value>::type>
+    result<T> HMGET(const std::string& key)
+    {
+        const char* _cmd = get_cmd(__FUNCTION__);
+        return redis_struct<T>::apply_names([&](const auto&... _fields) {
+            return driver.command(redis_convert_struct<T>(true), _cmd, key, _fields...);
+        });
+    }
+
+    //ȡvalue,ֻǴڵֶ,ֶζʱfalse
+    template<typename T, typename = typename std::enable_if<is_redis_struct<T>::value>::type>
+    result<bool> HMGET(const std::string& key, T& value)
+    {
+        const char* _cmd = get_cmd(__FUNCTION__);
+        return redis_struct<T>::apply_names([&](const auto&... _fields) {
+            return driver.command(redis_convert_struct_into<T>(&value, true), _cmd, key, _fields...);
+        });
+    }
+
+    result<bool> HMSET(const std::string& key, const std::map<std::string, std::string>& field_value_pairs) {
+        return driver.command(redis_convert_ok(), get_cmd(__FUNCTION__), key, redis_pairs(field_value_pairs));
+    }
+
+    template<typename RANGE, typename std::enable_if<is_redis_pair_container<RANGE>::value, int>::type = 0>
+    result<bool> HMSET(const std::string& key, const RANGE& field_value_pairs) {
+        return driver.command(redis_convert_ok(), get_cmd(__FUNCTION__), key, redis_pairs(field_value_pairs));
+    }
+
+    template<typename D = DRIVER, typename std::enable_if<is_redis_chunked_driver<D>::value, int>::type = 0>
+    bool HMSET(const std::string& key, const std::map<std::string, std::string>& field_value_pairs, size_t chunk_size)
+    {
+        bool _ok = true;
+        auto _it = field_value_pairs.begin();
+        driver.chunked(get_cmd(__FUNCTION__), field_value_pairs.size(), chunk_size,
+            [&](size_t _begin, size_t _end, redis_command_args& argv) {
+                argv.push_back(key);
+                for (; _begin < _end; ++_begin, ++_it) {
+                    argv.push_back(_it->first);
+                    argv.push_back(_it->second);
+                }
+            },
+            [&](size_t, size_t, const redis_reply& _reply) {
+                _ok = _reply.is_ok() && _ok;
+            });
+        return _ok;
+    }
+
+    //дṹֶ,ֱֵֶӴӳԱ,мstd::map
+    template<typename T, typename = typename std::enable_if<is_redis_struct<T>::value>::type>
+    result<bool> HMSET(const std::string& key, const T& value)
+    {
+        const char* _cmd = get_cmd(__FUNCTION__);
+        return redis_struct<T>::apply_pairs(value, [&](const auto&... _pairs) {
+            return driver.command(redis_convert_ok(), _cmd, key, _pairs...);
+        });
+    }
+
+    result<bool> HSET(const std::string& key, const std::string& field, const std::string& value) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), key, field, value);
+    }
+
+    result<bool> HSETNX(const std::string& key, const std::string& field, const std::string& value) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), key, field, value);
+    }
+        
+    result<std::vector<std::string>> HVALS(const std::string& key) {
+        return driver.command(redis_convert<std::vector<std::string>>(), get_cmd(__FUNCTION__), key);
+    }
+        
+    //cbfalseʱɨ
+    template<typename D = DRIVER, typename std::enable_if<is_redis_sync_driver<D>::value, int>::type = 0>
+    void HSCAN(const std::string& key, const std::string& match = "*", int count = 10,
+        std::function<bool(const std::string&, const std::string&)> cb =
+        [](const std::string& /*field*/, const std::string& /*value*/) { return true; },
+        redis_scan_dedup dedup = redis_scan_dedup())
+    {
+        int64_t _pos = 0;
+        do
         {
-            int64_t _pos = 0;
-            std::set<std::string> _fields;
-            do
-            {
-                auto _pair = (std::pair<tc_redis::redis_value, std::map<std::string, std::string>>)
-                    redis_reply(context, get_cmd(__FUNCTION__), key, _pos, "MATCH", match, "COUNT", count);
+            auto _pair = driver.command(redis_convert<std::pair<tc_redis::redis_value, std::map<std::string, std::string>>>(),
+                get_cmd(__FUNCTION__), key, _pos, "MATCH", match, "COUNT", count);
 
-                _pos = _pair.first.as_int();
+            _pos = _pair.first.as_int();
 
-                for (auto& _field_value_pair : _pair.second) {
-                    if (_fields.insert(_field_value_pair.first).second) {
-                        if (!cb(_field_value_pair.first, _field_value_pair.second)) {
-                            break;
-                        }
-                    }
+            for (auto& _field_value_pair : _pair.second) {
+                if (dedup.insert(_field_value_pair.first) && !cb(_field_value_pair.first, _field_value_pair.second)) {
+                    return;
                 }
+            }
 
-            } while (_pos);
+        } while (_pos);
 
-        }
+    }
 
-    };
-    ////////////////////////////////////////////////////////////////////////////////////////////
-    class redis_list
+};
+////////////////////////////////////////////////////////////////////////////////////////////
+template<typename DRIVER>
+class redis_list : public redis_facade
+{
+protected:
+    DRIVER driver;
+
+    template<typename T> using result = typename DRIVER::template result<T>;
+public:
+    redis_list(const DRIVER& _driver) :driver(_driver) {
+    }
+
+    result<redis_optional<std::pair<std::string, std::string>>> BLPOP(const std::vector<std::string>& keys, int timeout) 
     {
-    protected:
-        friend class redis_context;
-        redisContext* context;
+        redis_command_args argv;
+        argv.append(keys.begin(), keys.end());
+        argv.push_back(timeout);
 
-        redis_list(redisContext* _context) :context(_context) {
-        }
-    public:
-        redis_optional<std::pair<std::string, std::string>> BLPOP(const std::vector<std::string>& keys, int timeout) 
-        {
-            std::vector<std::string> argv = keys;
-            argv.push_back(std::to_string(timeout));
+        return driver.command(redis_convert_optional<std::pair<std::string, std::string>>(), get_cmd(__FUNCTION__), argv);
+    }
 
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), argv);
-            
-            return _reply.is_nil() ? redis_nullopt :
-                redis_make_optional((std::pair<std::string, std::string>)_reply);
-        }
+    result<redis_optional<std::pair<std::string, std::string>>> BRPOP(const std::vector<std::string>& keys, int timeout)
+    {
+        redis_command_args argv;
+        argv.append(keys.begin(), keys.end());
+        argv.push_back(timeout);
+
+        return driver.command(redis_convert_optional<std::pair<std::string, std::string>>(), get_cmd(__FUNCTION__), argv);
+    }
+
+    result<std::pair<redis_optional<std::string>, std::string>> BRPOPLPUSH(const std::string& source, const std::string& destination, int timeout)
+    {
+        return driver.command(redis_convert<std::pair<redis_optional<std::string>, std::string>>(), get_cmd(__FUNCTION__),
+            source, destination, timeout);
+    }
+
+    result<redis_optional<std::string>> LINDEX(const std::string& key, int index)
+    {
+        return driver.command(redis_convert_optional<std::string>(), get_cmd(__FUNCTION__), key, index);
+    }
+
+    result<int64_t> LINSERT(const std::string& key, const std::string& pivot, const std::string& value, bool after = false) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, (after ? "AFTER" : "BEFORE"), pivot, value);
+    }
+
+    result<int64_t> LLEN(const std::string& key) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key);
+    }
+
+    result<redis_optional<std::string>> LPOP(const std::string& key)
+    {
+        return driver.command(redis_convert_optional<std::string>(), get_cmd(__FUNCTION__), key);
+    }
+
+    result<int64_t> LPUSH(const std::string& key, const std::vector<std::string>& values) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, redis_args(values));
+    }
 
-        redis_optional<std::pair<std::string, std::string>> BRPOP(const std::vector<std::string>& keys, int timeout)
-        {
-            std::vector<std::string> argv = keys;
-            argv.push_back(std::to_string(timeout));
+    template<typename RANGE, typename std::enable_if<is_redis_arg_container<RANGE>::value, int>::type = 0>
+    result<int64_t> LPUSH(const std::string& key, const RANGE& values) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, redis_args(values));
+    }
 
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), argv);
+    result<int64_t> LPUSHX(const std::string& key, const std::string& value) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, value);
+    }
 
-            return _reply.is_nil() ? redis_nullopt :
-                redis_make_optional((std::pair<std::string, std::string>)_reply);
-        }
+    result<std::vector<std::string>> LRANGE(const std::string& key, int start, int stop) {
+        return driver.command(redis_convert<std::vector<std::string>>(), get_cmd(__FUNCTION__), key, start, stop);
+    }
 
-        std::pair<redis_optional<std::string>, std::string> BRPOPLPUSH(const std::string& source, const std::string& destination, int timeout)
-        {
-            auto p = (std::vector<redis_reply>)redis_reply(context, get_cmd(__FUNCTION__), source, destination, timeout);
+    result<int64_t> LREM(const std::string& key, int count, const std::string& value) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, count, value);
+    }
 
-            return std::make_pair(
-                (p[0].is_nil() ? redis_nullopt : redis_make_optional((std::string)p[0])),
-                (std::string)p[1]);
-        }
+    result<bool> LSET(const std::string& key, int index, const std::string& value) {
+        return driver.command(redis_convert_ok(), get_cmd(__FUNCTION__), key, index, value);
+    }
 
-        redis_optional<std::string> LINDEX(const std::string& key, int index)
-        {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key, index);
+    result<bool> LTRIM(const std::string& key, int start, int stop) {
+        return driver.command(redis_convert_ok(), get_cmd(__FUNCTION__), key, start, stop);
+    }
 
-            return _reply.is_nil() ? redis_nullopt :
-                redis_make_optional((std::string)_reply);
-        }
+    result<redis_optional<std::string>> RPOP(const std::string& key)
+    {
+        return driver.command(redis_convert_optional<std::string>(), get_cmd(__FUNCTION__), key);
+    }
 
-        int64_t LINSERT(const std::string& key, const std::string& pivot, const std::string& value, bool after = false) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, (after ? "AFTER" : "BEFORE"), pivot, value);
-        }
+    result<redis_optional<std::string>> RPOPLPUSH(const std::string& source, const std::string& destination)
+    {
+        return driver.command(redis_convert_optional<std::string>(), get_cmd(__FUNCTION__), source, destination);
+    }
 
-        int64_t LLEN(const std::string& key) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key);
-        }
+    result<int64_t> RPUSH(const std::string& key, const std::vector<std::string>& values) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, redis_args(values));
+    }
 
-        redis_optional<std::string> LPOP(const std::string& key)
-        {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key);
+    template<typename RANGE, typename std::enable_if<is_redis_arg_container<RANGE>::value, int>::type = 0>
+    result<int64_t> RPUSH(const std::string& key, const RANGE& values) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, redis_args(values));
+    }
 
-            return _reply.is_nil() ? redis_nullopt :
-                redis_make_optional((std::string)_reply);
-        }
+    result<int64_t> RPUSHX(const std::string& key, const std::string& value) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, value);
+    }
+};
+////////////////////////////////////////////////////////////////////////////////////////////
+template<typename DRIVER>
+class redis_stream : public redis_facade
+{
+protected:
+    DRIVER driver;
 
-        int64_t LPUSH(const std::string& key, const std::vector<std::string>& values)
-        {
-            std::vector<std::string> argv = { key };
-            argv.insert(argv.end(), values.begin(), values.end());
+    template<typename T> using result = typename DRIVER::template result<T>;
 
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv);
+    //XREAD/XREADGROUPĹ,BLOCKNOACKд,STREAMS
+    template<typename... ARGS>
+    result<std::vector<redis_stream_result>> read(const char* _cmd, int64_t block, bool noack,
+        const std::vector<std::string>& keys, const std::vector<std::string>& ids, ARGS&&... _args)
+    {
+        redis_test(!keys.empty() && keys.size() == ids.size(), redis_error_code::command_error, _cmd);
+        if (block < 0 && !noack) {
+            return driver.command(redis_convert_streams(), _cmd, _args..., "STREAMS", redis_args(keys), redis_args(ids));
         }
-
-        int64_t LPUSHX(const std::string& key, const std::string& value) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, value);
+        if (block < 0) {
+            return driver.command(redis_convert_streams(), _cmd, _args..., "NOACK", "STREAMS", redis_args(keys), redis_args(ids));
         }
-
-        std::vector<std::string> LRANGE(const std::string& key, int start, int stop) {
-            return (std::vector<std::string>)redis_reply(context, get_cmd(__FUNCTION__), key, start, stop);
+        if (!noack) {
+            return driver.command(redis_convert_streams(), _cmd, _args..., "BLOCK", block, "STREAMS", redis_args(keys), redis_args(ids));
         }
+        return driver.command(redis_convert_streams(), _cmd, _args..., "BLOCK", block, "NOACK", "STREAMS", redis_args(keys), redis_args(ids));
+    }
+public:
+    redis_stream(const DRIVER& _driver) :driver(_driver) {
+    }
 
-        int64_t LREM(const std::string& key, int count, const std::string& value) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, count, value);
-        }
+    //idΪ"*"ʱɷ
+    result<redis_stream_id> XADD(const std::string& key, const std::vector<std::pair<std::string, std::string>>& fields,
+        const std::string& id = "*") {
+        return driver.command(redis_convert_stream_id(), get_cmd(__FUNCTION__), key, id, redis_pairs(fields));
+    }
 
-        bool LSET(const std::string& key, int index, const std::string& value) {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key, index, value);
-            return _reply.is_ok();
-        }
+    template<typename FIELDS, typename std::enable_if<is_redis_pair_container<FIELDS>::value, int>::type = 0>
+    result<redis_stream_id> XADD(const std::string& key, const FIELDS& fields, const std::string& id = "*") {
+        return driver.command(redis_convert_stream_id(), get_cmd(__FUNCTION__), key, id, redis_pairs(fields));
+    }
 
-        bool LTRIM(const std::string& key, int start, int stop) {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key, start, stop);
-            return _reply.is_ok();
-        }
+    //дmaxlenü,approximateΪtrueʱʹ"~",ɷڵü,С
+    result<redis_stream_id> XADD(const std::string& key, size_t maxlen,
+        const std::vector<std::pair<std::string, std::string>>& fields, bool approximate = true) {
+        return driver.command(redis_convert_stream_id(), get_cmd(__FUNCTION__), key,
+            "MAXLEN", (approximate ? "~" : "="), maxlen, "*", redis_pairs(fields));
+    }
 
-        redis_optional<std::string> RPOP(const std::string& key)
-        {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key);
+    template<typename FIELDS, typename std::enable_if<is_redis_pair_container<FIELDS>::value, int>::type = 0>
+    result<redis_stream_id> XADD(const std::string& key, size_t maxlen, const FIELDS& fields, bool approximate = true) {
+        return driver.command(redis_convert_stream_id(), get_cmd(__FUNCTION__), key,
+            "MAXLEN", (approximate ? "~" : "="), maxlen, "*", redis_pairs(fields));
+    }
 
-            return _reply.is_nil() ? redis_nullopt :
-                redis_make_optional((std::string)_reply);
-        }
+    result<int64_t> XLEN(const std::string& key) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key);
+    }
 
-        redis_optional<std::string> RPOPLPUSH(const std::string& source, const std::string& destination)
-        {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), source, destination);
+    //countΪ0ʱ
+    result<std::vector<redis_stream_entry>> XRANGE(const std::string& key, const std::string& start = "-",
+        const std::string& end = "+", int64_t count = 0)
+    {
+        if (count > 0) {
+            return driver.command(redis_convert_stream_entries(), get_cmd(__FUNCTION__), key, start, end, "COUNT", count);
+        }
+        return driver.command(redis_convert_stream_entries(), get_cmd(__FUNCTION__), key, start, end);
+    }
 
-            return _reply.is_nil() ? redis_nullopt :
-                redis_make_optional((std::string)_reply);
+    result<std::vector<redis_stream_entry>> XREVRANGE(const std::string& key, const std::string& end = "+",
+        const std::string& start = "-", int64_t count = 0)
+    {
+        if (count > 0) {
+            return driver.command(redis_convert_stream_entries(), get_cmd(__FUNCTION__), key, end, start, "COUNT", count);
         }
+        return driver.command(redis_convert_stream_entries(), get_cmd(__FUNCTION__), key, end, start);
+    }
 
-        int64_t RPUSH(const std::string& key, const std::vector<std::string>& values)
-        {
-            std::vector<std::string> argv = { key };
-            argv.insert(argv.end(), values.begin(), values.end());
+    result<int64_t> XDEL(const std::string& key, const std::vector<redis_stream_id>& ids) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, redis_args(ids));
+    }
 
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv);
-        }
+    result<int64_t> XTRIM(const std::string& key, size_t maxlen, bool approximate = true) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, "MAXLEN", (approximate ? "~" : "="), maxlen);
+    }
 
-        int64_t RPUSHX(const std::string& key, const std::string& value) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, value);
-        }
-    };
-    ////////////////////////////////////////////////////////////////////////////////////////////
-    class redis_set
+    //Ӷȡids֮Ŀ,ids"$"ʾֻĿ
+    //countΪ0ʱ,blockΪ,С0ʱ,ʱӵĶʱҪblock
+    result<std::vector<redis_stream_result>> XREAD(const std::vector<std::string>& keys, const std::vector<std::string>& ids,
+        int64_t count = 0, int64_t block = -1)
     {
-    protected:
-        friend class redis_context;
-        redisContext* context;
+        return read(get_cmd(__FUNCTION__), block, false, keys, ids, "COUNT", count);
+    }
 
-        redis_set(redisContext* _context) :context(_context) {
-        }
-    public:
+    //ݶȡ,ids">"ʾδͶݹĿ,IDʾߴȷϵĿ
+    result<std::vector<redis_stream_result>> XREADGROUP(const std::string& group, const std::string& consumer,
+        const std::vector<std::string>& keys, const std::vector<std::string>& ids,
+        int64_t count = 0, int64_t block = -1, bool noack = false)
+    {
+        return read(get_cmd(__FUNCTION__), block, noack, keys, ids, "GROUP", group, consumer, "COUNT", count);
+    }
 
-        int64_t SADD(const std::string& key, const std::vector<std::string>& members)
-        {
-            std::vector<std::string> argv = { key };
-            argv.insert(argv.end(), members.begin(), members.end());
+    result<int64_t> XACK(const std::string& key, const std::string& group, const std::vector<redis_stream_id>& ids) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, group, redis_args(ids));
+    }
 
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv);
+    //,ѴʱBUSYGROUP
+    result<bool> XGROUP_CREATE(const std::string& key, const std::string& group, const std::string& id = "$", bool mkstream = true)
+    {
+        if (mkstream) {
+            return driver.command(redis_convert_ok(), "XGROUP", "CREATE", key, group, id, "MKSTREAM");
         }
+        return driver.command(redis_convert_ok(), "XGROUP", "CREATE", key, group, id);
+    }
 
-        int64_t SCARD(const std::string& key) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key);
-        }
+    result<int64_t> XGROUP_DESTROY(const std::string& key, const std::string& group) {
+        return driver.command(redis_convert<int64_t>(), "XGROUP", "DESTROY", key, group);
+    }
+};
+////////////////////////////////////////////////////////////////////////////////////////////
+template<typename DRIVER>
+class redis_set : public redis_facade
+{
+protected:
+    DRIVER driver;
 
-        std::set<std::string> SDIFF(const std::vector<std::string>& keys) {
-            return (std::set<std::string>)redis_reply(context, get_cmd(__FUNCTION__), keys);
-        }
+    template<typename T> using result = typename DRIVER::template result<T>;
+public:
+    redis_set(const DRIVER& _driver) :driver(_driver) {
+    }
 
-        int64_t SDIFFSTORE(const std::string& destination ,const std::vector<std::string>& keys)
-        {
-            std::vector<std::string> argv = { destination };
-            argv.insert(argv.end(), keys.begin(), keys.end());
 
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv);
-        }
+    result<int64_t> SADD(const std::string& key, const std::vector<std::string>& members) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, redis_args(members));
+    }
 
-        std::set<std::string> SINTER(const std::vector<std::string>& keys) {
-            return (std::set<std::string>)redis_reply(context, get_cmd(__FUNCTION__), keys);
-        }
+    template<typename RANGE, typename std::enable_if<is_redis_arg_container<RANGE>::value, int>::type = 0>
+    result<int64_t> SADD(const std::string& key, const RANGE& members) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, redis_args(members));
+    }
 
-        int64_t SINTERSTORE(const std::string& destination, const std::vector<std::string>& keys)
-        {
-            std::vector<std::string> argv = { destination };
-            argv.insert(argv.end(), keys.begin(), keys.end());
+    result<int64_t> SCARD(const std::string& key) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key);
+    }
 
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv);
-        }
+    result<std::set<std::string>> SDIFF(const std::vector<std::string>& keys) {
+        return driver.command(redis_convert<std::set<std::string>>(), get_cmd(__FUNCTION__), keys);
+    }
 
-        bool SISMEMBER(const std::string& key, const std::string& member) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, member) != 0;
-        }
+    result<int64_t> SDIFFSTORE(const std::string& destination ,const std::vector<std::string>& keys)
+    {
+        redis_command_args argv;
+        argv.push_back(destination);
+        argv.append(keys.begin(), keys.end());
 
-        std::set<std::string> SMEMBERS(const std::string& key) {
-            return (std::set<std::string>)redis_reply(context, get_cmd(__FUNCTION__), key);
-        }
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), argv);
+    }
 
-        bool SMOVE(const std::string& source, const std::string& destination, const std::string& member) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), source, destination, member) != 0;
-        }
+    result<std::set<std::string>> SINTER(const std::vector<std::string>& keys) {
+        return driver.command(redis_convert<std::set<std::string>>(), get_cmd(__FUNCTION__), keys);
+    }
 
-        redis_optional<std::string> SPOP(const std::string& key)
-        {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key);
+    result<int64_t> SINTERSTORE(const std::string& destination, const std::vector<std::string>& keys)
+    {
+        redis_command_args argv;
+        argv.push_back(destination);
+        argv.append(keys.begin(), keys.end());
 
-            return _reply.is_nil() ? redis_nullopt :
-                redis_make_optional((std::string)_reply);
-        }
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), argv);
+    }
 
-        redis_optional<std::string> SRANDMEMBER(const std::string& key)
-        {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key);
+    result<bool> SISMEMBER(const std::string& key, const std::string& member) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), key, member);
+    }
 
-            return _reply.is_nil() ? redis_nullopt :
-                redis_make_optional((std::string)_reply);
-        }
-        std::vector<std::string> SRANDMEMBER(const std::string& key, int count) {
-            return (std::vector<std::string>)redis_reply(context, get_cmd(__FUNCTION__), key, count);
-        }
+    result<std::set<std::string>> SMEMBERS(const std::string& key) {
+        return driver.command(redis_convert<std::set<std::string>>(), get_cmd(__FUNCTION__), key);
+    }
 
-        int64_t SREM(const std::string& key, const std::vector<std::string>& members)
-        {
-            std::vector<std::string> argv = { key };
-            argv.insert(argv.end(), members.begin(), members.end());
+    result<bool> SMOVE(const std::string& source, const std::string& destination, const std::string& member) {
+        return driver.command(redis_convert_nonzero(), get_cmd(__FUNCTION__), source, destination, member);
+    }
 
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv);
-        }
+    result<redis_optional<std::string>> SPOP(const std::string& key)
+    {
+        return driver.command(redis_convert_optional<std::string>(), get_cmd(__FUNCTION__), key);
+    }
 
-        std::set<std::string> SUNION(const std::vector<std::string>& keys) {
-            return (std::set<std::string>)redis_reply(context, get_cmd(__FUNCTION__), keys);
-        }
+    result<redis_optional<std::string>> SRANDMEMBER(const std::string& key)
+    {
+        return driver.command(redis_convert_optional<std::string>(), get_cmd(__FUNCTION__), key);
+    }
+    result<std::vector<std::string>> SRANDMEMBER(const std::string& key, int count) {
+        return driver.command(redis_convert<std::vector<std::string>>(), get_cmd(__FUNCTION__), key, count);
+    }
 
-        int64_t SUNIONSTORE(const std::string& destination, const std::vector<std::string>& keys)
-        {
-            std::vector<std::string> argv = { destination };
-            argv.insert(argv.end(), keys.begin(), keys.end());
+    result<int64_t> SREM(const std::string& key, const std::vector<std::string>& members) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, redis_args(members));
+    }
 
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv);
-        }
+    template<typename RANGE, typename std::enable_if<is_redis_arg_container<RANGE>::value, int>::type = 0>
+    result<int64_t> SREM(const std::string& key, const RANGE& members) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, redis_args(members));
+    }
+
+    result<std::set<std::string>> SUNION(const std::vector<std::string>& keys) {
+        return driver.command(redis_convert<std::set<std::string>>(), get_cmd(__FUNCTION__), keys);
+    }
+
+    result<int64_t> SUNIONSTORE(const std::string& destination, const std::vector<std::string>& keys)
+    {
+        redis_command_args argv;
+        argv.push_back(destination);
+        argv.append(keys.begin(), keys.end());
+
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), argv);
+    }
 
-        void SSCAN(const std::string& key, const std::string& match = "*", int count = 10,
-            std::function<bool(const std::string& member)> cb = [](const std::string&) { return true; })
+    //cbfalseʱɨ
+    template<typename D = DRIVER, typename std::enable_if<is_redis_sync_driver<D>::value, int>::type = 0>
+    void SSCAN(const std::string& key, const std::string& match = "*", int count = 10,
+        std::function<bool(const std::string& member)> cb = [](const std::string&) { return true; },
+        redis_scan_dedup dedup = redis_scan_dedup())
+    {
+        int64_t _pos = 0;
+        do
         {
-            int64_t _pos = 0;
-            std::set<std::string> _members;
-            do
-            {
-                auto _pair = (std::pair<tc_redis::redis_value, std::vector<std::string>>)
-                    redis_reply(context, get_cmd(__FUNCTION__), key, _pos, "MATCH", match, "COUNT", count);
+            auto _pair = driver.command(redis_convert<std::pair<tc_redis::redis_value, std::vector<std::string>>>(),
+                get_cmd(__FUNCTION__), key, _pos, "MATCH", match, "COUNT", count);
 
-                _pos = _pair.first.as_int();
+            _pos = _pair.first.as_int();
 
-                for (auto& _member : _pair.second) {
-                    if (_members.insert(_member).second) {
-                        if (!cb(_member)) {
-                            break;
-                        }
-                    }
+            for (auto& _member : _pair.second) {
+                if (dedup.insert(_member) && !cb(_member)) {
+                    return;
                 }
+            }
 
-            } while (_pos);
+        } while (_pos);
 
-        }
-    };
-     
-    ////////////////////////////////////////////////////////////////////////////////////////////
-    class redis_sortedset
+    }
+};
+////////////////////////////////////////////////////////////////////////////////////////////
+template<typename DRIVER>
+class redis_sortedset : public redis_facade
+{
+protected:
+    template<typename CONVERT>
+    typename DRIVER::template result<typename CONVERT::result_type> range(const CONVERT& _convert, const char* _cmd,
+        const std::string& key, int start, int stop, bool with_scores)
     {
-    protected:
-        friend class redis_context;
-        redisContext* context;
-
-        redis_sortedset(redisContext* _context) :context(_context) {
+        if (with_scores) {
+            return driver.command(_convert, _cmd, key, start, stop, "WITHSCORES");
         }
-    public:
-        int64_t ZADD(const std::string& key, const std::map<std::string, std::string>& member_score_pairs)
-        {
-            std::vector<std::string> argv = { key };
-            for (auto& p : member_score_pairs) {
-                argv.push_back(p.second);
-                argv.push_back(p.first);
+        return driver.command(_convert, _cmd, key, start, stop);
+    }
+
+    template<typename CONVERT>
+    typename DRIVER::template result<typename CONVERT::result_type> range_by_score(const CONVERT& _convert, const char* _cmd,
+        const std::string& key, const std::string& min, const std::string& max, bool with_scores,
+        int limit_offset, unsigned int limit_count)
+    {
+        bool _limit = !(limit_offset == 0 && limit_count == -1);
+        if (with_scores) {
+            if (_limit) {
+                return driver.command(_convert, _cmd, key, min, max, "WITHSCORES", "LIMIT", limit_offset, limit_count);
             }
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv);
+            return driver.command(_convert, _cmd, key, min, max, "WITHSCORES");
         }
-
-        int64_t ZCARD(const std::string& key) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key);
+        if (_limit) {
+            return driver.command(_convert, _cmd, key, min, max, "LIMIT", limit_offset, limit_count);
         }
+        return driver.command(_convert, _cmd, key, min, max);
+    }
 
-        int64_t ZCOUNT(const std::string& key, const std::string& min, const std::string& max) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, min, max);
-        }
+    DRIVER driver;
 
-        std::string ZINCRBY(const std::string& key, const std::string& increment, const std::string& member) {
-            return (std::string)redis_reply(context, get_cmd(__FUNCTION__), key, increment, member);
-        }
-     
-        std::map<std::string, std::string> ZRANGE(const std::string& key, int start, int stop, bool with_scores = false)
-        {
-            if (with_scores) {
-                return (std::map<std::string, std::string>)redis_reply(context, get_cmd(__FUNCTION__), key, start, stop, "WITHSCORES");
-            }
+    template<typename T> using result = typename DRIVER::template result<T>;
+public:
+    redis_sortedset(const DRIVER& _driver) :driver(_driver) {
+    }
 
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key, start, stop);
+    result<int64_t> ZADD(const std::string& key, const std::map<std::string, std::string>& member_score_pairs) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, redis_pairs(member_score_pairs, true));
+    }
 
-            std::map<std::string, std::string> _m;
-            for (auto& _member : (std::set<std::string>)_reply) {
-                _m[_member] = "0";
-            }
-            return _m;
+    //member_score_pairsԪΪ(member, score),scoreֱֵ
+    template<typename RANGE, typename std::enable_if<is_redis_pair_container<RANGE>::value, int>::type = 0>
+    result<int64_t> ZADD(const std::string& key, const RANGE& member_score_pairs) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, redis_pairs(member_score_pairs, true));
+    }
+
+    result<int64_t> ZCARD(const std::string& key) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key);
+    }
+
+    result<int64_t> ZCOUNT(const std::string& key, const std::string& min, const std::string& max) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, min, max);
+    }
+
+    result<std::string> ZINCRBY(const std::string& key, const std::string& increment, const std::string& member) {
+        return driver.command(redis_convert<std::string>(), get_cmd(__FUNCTION__), key, increment, member);
+    }
+ 
+    //std::mapԱ,Ҫ˳ֵʱʹWITHSCORES/MEMBERS
+    enum { WITHSCORES };
+    enum { MEMBERS };
+
+    result<std::map<std::string, std::string>> ZRANGE(const std::string& key, int start, int stop, bool with_scores = false)
+    {
+        if (with_scores) {
+            return driver.command(redis_convert<std::map<std::string, std::string>>(), get_cmd(__FUNCTION__), key, start, stop, "WITHSCORES");
         }
 
-        std::map<std::string, std::string> ZRANGEBYSCORE(const std::string& key,
-            const std::string& min, const std::string& max, bool with_scores = false,
-            int limit_offset = 0, unsigned int limit_count = -1)
-        {
-            if (with_scores) {
-                if (!(limit_offset == 0 && limit_count == -1)) {
-                    return (std::map<std::string, std::string>)redis_reply(context, get_cmd(__FUNCTION__), key,
-                        min, max, "WITHSCORES", "LIMIT", limit_offset, limit_count);
-                }
-                else {
-                    return (std::map<std::string, std::string>)redis_reply(context, get_cmd(__FUNCTION__), key,
-                        min, max, "WITHSCORES");
-                }
-            }
+        return driver.command(redis_convert_member_map(), get_cmd(__FUNCTION__), key, start, stop);
+    }
 
-            redis_reply _reply = !(limit_offset == 0 && limit_count == -1) ?
-                redis_reply(context, get_cmd(__FUNCTION__), key, min, max, "LIMIT", limit_offset, limit_count) :
-                redis_reply(context, get_cmd(__FUNCTION__), key, min, max);
+    //˳򷵻سԱ
+    result<std::vector<redis_scored_member>> ZRANGE(const std::string& key, int start, int stop, decltype(WITHSCORES) /*WITHSCORES*/) {
+        return range(redis_convert_scored(), get_cmd(__FUNCTION__), key, start, stop, true);
+    }
+    //˳򷵻سԱ
+    result<std::vector<std::string>> ZRANGE(const std::string& key, int start, int stop, decltype(MEMBERS) /*MEMBERS*/) {
+        return range(redis_convert_members(), get_cmd(__FUNCTION__), key, start, stop, false);
+    }
+    //дout,out,ظ
+    result<size_t> ZRANGE(const std::string& key, int start, int stop, std::vector<redis_scored_member>& out) {
+        return range(redis_convert_into<std::vector<redis_scored_member>>(&out), get_cmd(__FUNCTION__), key, start, stop, true);
+    }
+    result<size_t> ZRANGE(const std::string& key, int start, int stop, std::vector<std::string>& out) {
+        return range(redis_convert_into<std::vector<std::string>>(&out), get_cmd(__FUNCTION__), key, start, stop, false);
+    }
 
-            std::map<std::string, std::string> _m;
-            for (auto& _member : (std::set<std::string>)_reply) {
-                _m[_member] = "0";
+    result<std::map<std::string, std::string>> ZRANGEBYSCORE(const std::string& key,
+        const std::string& min, const std::string& max, bool with_scores = false,
+        int limit_offset = 0, unsigned int limit_count = -1)
+    {
+        if (with_scores) {
+            if (!(limit_offset == 0 && limit_count == -1)) {
+                return driver.command(redis_convert<std::map<std::string, std::string>>(), get_cmd(__FUNCTION__), key,
+                    min, max, "WITHSCORES", "LIMIT", limit_offset, limit_count);
+            }
+            else {
+                return driver.command(redis_convert<std::map<std::string, std::string>>(), get_cmd(__FUNCTION__), key,
+                    min, max, "WITHSCORES");
             }
-            return _m;
         }
 
-        int64_t ZRANK(const std::string& key, const std::string& member)
-        {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key, member);
-
-            return _reply.is_nil() ? -1 : (int64_t)_reply;
+        if (!(limit_offset == 0 && limit_count == -1)) {
+            return driver.command(redis_convert_member_map(), get_cmd(__FUNCTION__), key,
+                min, max, "LIMIT", limit_offset, limit_count);
         }
+        else {
+            return driver.command(redis_convert_member_map(), get_cmd(__FUNCTION__), key, min, max);
+        }
+    }
 
-        int64_t ZREM(const std::string& key, const std::vector<std::string>& members)
-        {
-            std::vector<std::string> argv = { key };
-            argv.insert(argv.end(), members.begin(), members.end());
+    //˳򷵻سԱ
+    result<std::vector<redis_scored_member>> ZRANGEBYSCORE(const std::string& key,
+        const std::string& min, const std::string& max, decltype(WITHSCORES) /*WITHSCORES*/,
+        int limit_offset = 0, unsigned int limit_count = -1)
+    {
+        return range_by_score(redis_convert_scored(), get_cmd(__FUNCTION__), key, min, max, true, limit_offset, limit_count);
+    }
+    //˳򷵻سԱ
+    result<std::vector<std::string>> ZRANGEBYSCORE(const std::string& key,
+        const std::string& min, const std::string& max, decltype(MEMBERS) /*MEMBERS*/,
+        int limit_offset = 0, unsigned int limit_count = -1)
+    {
+        return range_by_score(redis_convert_members(), get_cmd(__FUNCTION__), key, min, max, false, limit_offset, limit_count);
+    }
+    //дout,out,ظ
+    result<size_t> ZRANGEBYSCORE(const std::string& key, const std::string& min, const std::string& max,
+        std::vector<redis_scored_member>& out, int limit_offset = 0, unsigned int limit_count = -1)
+    {
+        return range_by_score(redis_convert_into<std::vector<redis_scored_member>>(&out), get_cmd(__FUNCTION__),
+            key, min, max, true, limit_offset, limit_count);
+    }
+    result<size_t> ZRANGEBYSCORE(const std::string& key, const std::string& min, const std::string& max,
+        std::vector<std::string>& out, int limit_offset = 0, unsigned int limit_count = -1)
+    {
+        return range_by_score(redis_convert_into<std::vector<std::string>>(&out), get_cmd(__FUNCTION__),
+            key, min, max, false, limit_offset, limit_count);
+    }
 
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv);
-        }
+    result<int64_t> ZRANK(const std::string& key, const std::string& member)
+    {
+        return driver.command(redis_convert_rank(), get_cmd(__FUNCTION__), key, member);
+    }
 
-        int64_t ZREMRANGEBYRANK(const std::string& key, int start, int stop) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, start, stop);
-        }
+    result<int64_t> ZREM(const std::string& key, const std::vector<std::string>& members) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, redis_args(members));
+    }
 
-        int64_t ZREMRANGEBYSCORE(const std::string& key, const std::string& min, const std::string& max) {
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), key, min, max);
-        }
+    template<typename RANGE, typename std::enable_if<is_redis_arg_container<RANGE>::value, int>::type = 0>
+    result<int64_t> ZREM(const std::string& key, const RANGE& members) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, redis_args(members));
+    }
 
-        std::map<std::string, std::string> ZREVRANGE(const std::string& key, int start, int stop, bool with_scores = false)
-        {
-            if (with_scores) {
-                return (std::map<std::string, std::string>)redis_reply(context, get_cmd(__FUNCTION__), key, start, stop, "WITHSCORES");
-            }
+    result<int64_t> ZREMRANGEBYRANK(const std::string& key, int start, int stop) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, start, stop);
+    }
 
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key, start, stop);
+    result<int64_t> ZREMRANGEBYSCORE(const std::string& key, const std::string& min, const std::string& max) {
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), key, min, max);
+    }
 
-            std::map<std::string, std::string> _m;
-            for (auto& _member : (std::set<std::string>)_reply) {
-                _m[_member] = "0";
-            }
-            return _m;
+    result<std::map<std::string, std::string>> ZREVRANGE(const std::string& key, int start, int stop, bool with_scores = false)
+    {
+        if (with_scores) {
+            return driver.command(redis_convert<std::map<std::string, std::string>>(), get_cmd(__FUNCTION__), key, start, stop, "WITHSCORES");
         }
 
-        std::map<std::string, std::string> ZREVRANGEBYSCORE(const std::string& key,
-            const std::string& min, const std::string& max, bool with_scores = false,
-            int limit_offset = 0, unsigned int limit_count = -1)
-        {
-            if (with_scores) {
-                if (!(limit_offset == 0 && limit_count == -1)) {
-                    return (std::map<std::string, std::string>)redis_reply(context, get_cmd(__FUNCTION__), key,
-                        min, max, "WITHSCORES", "LIMIT", limit_offset, limit_count);
-                }
-                else {
-                    return (std::map<std::string, std::string>)redis_reply(context, get_cmd(__FUNCTION__), key,
-                        min, max, "WITHSCORES");
-                }
-            }
+        return driver.command(redis_convert_member_map(), get_cmd(__FUNCTION__), key, start, stop);
+    }
 
-            redis_reply _reply = !(limit_offset == 0 && limit_count == -1) ?
-                redis_reply(context, get_cmd(__FUNCTION__), key, min, max, "LIMIT", limit_offset, limit_count) :
-                redis_reply(context, get_cmd(__FUNCTION__), key, min, max);
+    //˳򷵻سԱ
+    result<std::vector<redis_scored_member>> ZREVRANGE(const std::string& key, int start, int stop, decltype(WITHSCORES) /*WITHSCORES*/) {
+        return range(redis_convert_scored(), get_cmd(__FUNCTION__), key, start, stop, true);
+    }
+    //˳򷵻سԱ
+    result<std::vector<std::string>> ZREVRANGE(const std::string& key, int start, int stop, decltype(MEMBERS) /*MEMBERS*/) {
+        return range(redis_convert_members(), get_cmd(__FUNCTION__), key, start, stop, false);
+    }
+    //дout,out,ظ
+    result<size_t> ZREVRANGE(const std::string& key, int start, int stop, std::vector<redis_scored_member>& out) {
+        return range(redis_convert_into<std::vector<redis_scored_member>>(&out), get_cmd(__FUNCTION__), key, start, stop, true);
+    }
+    result<size_t> ZREVRANGE(const std::string& key, int start, int stop, std::vector<std::string>& out) {
+        return range(redis_convert_into<std::vector<std::string>>(&out), get_cmd(__FUNCTION__), key, start, stop, false);
+    }
 
-            std::map<std::string, std::string> _m;
-            for (auto& _member : (std::set<std::string>)_reply) {
-                _m[_member] = "0";
+    result<std::map<std::string, std::string>> ZREVRANGEBYSCORE(const std::string& key,
+        const std::string& min, const std::string& max, bool with_scores = false,
+        int limit_offset = 0, unsigned int limit_count = -1)
+    {
+        if (with_scores) {
+            if (!(limit_offset == 0 && limit_count == -1)) {
+                return driver.command(redis_convert<std::map<std::string, std::string>>(), get_cmd(__FUNCTION__), key,
+                    min, max, "WITHSCORES", "LIMIT", limit_offset, limit_count);
+            }
+            else {
+                return driver.command(redis_convert<std::map<std::string, std::string>>(), get_cmd(__FUNCTION__), key,
+                    min, max, "WITHSCORES");
             }
-            return _m;
         }
 
-        int64_t ZREVRANK(const std::string& key, const std::string& member)
-        {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key, member);
-
-            return _reply.is_nil() ? -1 : (int64_t)_reply;
+        if (!(limit_offset == 0 && limit_count == -1)) {
+            return driver.command(redis_convert_member_map(), get_cmd(__FUNCTION__), key,
+                min, max, "LIMIT", limit_offset, limit_count);
         }
-
-        redis_optional<std::string> ZSCORE(const std::string& key, const std::string& member)
-        {
-            redis_reply _reply = redis_reply(context, get_cmd(__FUNCTION__), key, member);
-
-            return _reply.is_nil() ? redis_nullopt :
-                redis_make_optional((std::string)_reply);
+        else {
+            return driver.command(redis_convert_member_map(), get_cmd(__FUNCTION__), key, min, max);
         }
-        
-        enum {
-            SUM,
-            MIN,
-            MAX
-        };
-        int64_t ZUNIONSTORE(const std::string& destination, const std::vector<std::string>& keys,
-            const std::vector<std::string>& weights = {}, decltype(SUM) aggregate = SUM)
-        {
-            std::vector<std::string> argv = { destination };
+    }
 
-            argv.push_back(std::to_string(keys.size()));
-            argv.insert(argv.end(), keys.begin(), keys.end());
+    //˳򷵻سԱ
+    result<std::vector<redis_scored_member>> ZREVRANGEBYSCORE(const std::string& key,
+        const std::string& min, const std::string& max, decltype(WITHSCORES) /*WITHSCORES*/,
+        int limit_offset = 0, unsigned int limit_count = -1)
+    {
+        return range_by_score(redis_convert_scored(), get_cmd(__FUNCTION__), key, min, max, true, limit_offset, limit_count);
+    }
+    //˳򷵻سԱ
+    result<std::vector<std::string>> ZREVRANGEBYSCORE(const std::string& key,
+        const std::string& min, const std::string& max, decltype(MEMBERS) /*MEMBERS*/,
+        int limit_offset = 0, unsigned int limit_count = -1)
+    {
+        return range_by_score(redis_convert_members(), get_cmd(__FUNCTION__), key, min, max, false, limit_offset, limit_count);
+    }
+    //дout,out,ظ
+    result<size_t> ZREVRANGEBYSCORE(const std::string& key, const std::string& min, const std::string& max,
+        std::vector<redis_scored_member>& out, int limit_offset = 0, unsigned int limit_count = -1)
+    {
+        return range_by_score(redis_convert_into<std::vector<redis_scored_member>>(&out), get_cmd(__FUNCTION__),
+            key, min, max, true, limit_offset, limit_count);
+    }
+    result<size_t> ZREVRANGEBYSCORE(const std::string& key, const std::string& min, const std::string& max,
+        std::vector<std::string>& out, int limit_offset = 0, unsigned int limit_count = -1)
+    {
+        return range_by_score(redis_convert_into<std::vector<std::string>>(&out), get_cmd(__FUNCTION__),
+            key, min, max, false, limit_offset, limit_count);
+    }
 
-            auto _w = weights;
-            while (_w.size() < keys.size()) {
-                _w.push_back("1");
-            }
-            _w.resize(keys.size());
-            argv.insert(argv.end(), _w.begin(), _w.end());
+    result<int64_t> ZREVRANK(const std::string& key, const std::string& member)
+    {
+        return driver.command(redis_convert_rank(), get_cmd(__FUNCTION__), key, member);
+    }
 
-            argv.push_back("AGGREGATE");
-            switch (aggregate)
-            {
-            case SUM:
-                argv.push_back("SUM");
-                break;
-            case MIN:
-                argv.push_back("MIN");
-                break;
-            case MAX:
-                argv.push_back("MAX");
-                break;
+    result<redis_optional<std::string>> ZSCORE(const std::string& key, const std::string& member)
+    {
+        return driver.command(redis_convert_optional<std::string>(), get_cmd(__FUNCTION__), key, member);
+    }
+    
+    enum {
+        SUM,
+        MIN,
+        MAX
+    };
+    result<int64_t> ZUNIONSTORE(const std::string& destination, const std::vector<std::string>& keys,
+        const std::vector<std::string>& weights = {}, decltype(SUM) aggregate = SUM)
+    {
+        redis_command_args argv;
+        argv.push_back(destination);
+        argv.push_back(keys.size());
+        argv.append(keys.begin(), keys.end());
+
+        //weightsĲֲ1,Ĳֺ
+        if (!weights.empty()) {
+            argv.push_back("WEIGHTS");
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (i < weights.size()) {
+                    argv.push_back(weights[i]);
+                }
+                else {
+                    argv.push_back("1");
+                }
             }
-
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv);
         }
 
-        int64_t ZINTERSTORE(const std::string& destination, const std::vector<std::string>& keys,
-            const std::vector<std::string>& weights = {}, decltype(SUM) aggregate = SUM)
+        argv.push_back("AGGREGATE");
+        switch (aggregate)
         {
-            std::vector<std::string> argv = { destination };
-
-            argv.push_back(std::to_string(keys.size()));
-            argv.insert(argv.end(), keys.begin(), keys.end());
-
-            auto _w = weights;
-            while (_w.size() < keys.size()) {
-                _w.push_back("1");
-            }
-            _w.resize(keys.size());
-            argv.insert(argv.end(), _w.begin(), _w.end());
+        case SUM:
+            argv.push_back("SUM");
+            break;
+        case MIN:
+            argv.push_back("MIN");
+            break;
+        case MAX:
+            argv.push_back("MAX");
+            break;
+        }
+
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), argv);
+    }
 
-            argv.push_back("AGGREGATE");
-            switch (aggregate)
-            {
-            case SUM:
-                argv.push_back("SUM");
-                break;
-            case MIN:
-                argv.push_back("MIN");
-                break;
-            case MAX:
-                argv.push_back("MAX");
-                break;
+    result<int64_t> ZINTERSTORE(const std::string& destination, const std::vector<std::string>& keys,
+        const std::vector<std::string>& weights = {}, decltype(SUM) aggregate = SUM)
+    {
+        redis_command_args argv;
+        argv.push_back(destination);
+        argv.push_back(keys.size());
+        argv.append(keys.begin(), keys.end());
+
+        //weightsĲֲ1,Ĳֺ
+        if (!weights.empty()) {
+            argv.push_back("WEIGHTS");
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (i < weights.size()) {
+                    argv.push_back(weights[i]);
+                }
+                else {
+                    argv.push_back("1");
+                }
             }
-
-            return (int64_t)redis_reply(context, get_cmd(__FUNCTION__), argv);
         }
 
+        argv.push_back("AGGREGATE");
+        switch (aggregate)
+        {
+        case SUM:
+            argv.push_back("SUM");
+            break;
+        case MIN:
+            argv.push_back("MIN");
+            break;
+        case MAX:
+            argv.push_back("MAX");
+            break;
+        }
+
+        return driver.command(redis_convert<int64_t>(), get_cmd(__FUNCTION__), argv);
+    }
 
-        void ZSCAN(const std::string& key, const std::string& match = "*", int count = 10,
-            std::function<bool(const std::string&, const std::string&)> cb =
-            [](const std::string&, const std::string& /*member*/) { return true; })
+
+    //cbfalseʱɨ
+    template<typename D = DRIVER, typename std::enable_if<is_redis_sync_driver<D>::value, int>::type = 0>
+    void ZSCAN(const std::string& key, const std::string& match = "*", int count = 10,
+        std::function<bool(const std::string&, const std::string&)> cb =
+        [](const std::string&, const std::string& /*member*/) { return true; },
+        redis_scan_dedup dedup = redis_scan_dedup())
+    {
+        int64_t _pos = 0;
+        do
         {
-            int64_t _pos = 0;
-            std::set<std::string> _fields;
-            do
-            {
-                auto _pair = (std::pair<tc_redis::redis_value, std::map<std::string, std::string>>)
-                    redis_reply(context, get_cmd(__FUNCTION__), key, _pos, "MATCH", match, "COUNT", count);
+            auto _pair = driver.command(redis_convert<std::pair<tc_redis::redis_value, std::map<std::string, std::string>>>(),
+                get_cmd(__FUNCTION__), key, _pos, "MATCH", match, "COUNT", count);
 
-                _pos = _pair.first.as_int();
+            _pos = _pair.first.as_int();
 
-                for (auto& _member_score_pair : _pair.second) {
-                    if (_fields.insert(_member_score_pair.first).second) {
-                        if (!cb(_member_score_pair.first, _member_score_pair.second)) {
-                            break;
-                        }
-                    }
+            for (auto& _member_score_pair : _pair.second) {
+                if (dedup.insert(_member_score_pair.first) && !cb(_member_score_pair.first, _member_score_pair.second)) {
+                    return;
                 }
+            }
 
-            } while (_pos);
+        } while (_pos);
 
-        }
-    };
+    }
+};
+
+class redis_context
+{
+protected:
+    redisContext* context;
+    redis_tracer* tracer;
 public:
-    redis_context(redisContext* _context) :context(_context) {
+    //ԭǶredis_contextед,redis_context::redis_string::AND
+    using redis_key = tc_redis::redis_key<redis_context_driver>;
+    using redis_string = tc_redis::redis_string<redis_context_driver>;
+    using redis_hash = tc_redis::redis_hash<redis_context_driver>;
+    using redis_list = tc_redis::redis_list<redis_context_driver>;
+    using redis_set = tc_redis::redis_set<redis_context_driver>;
+    using redis_sortedset = tc_redis::redis_sortedset<redis_context_driver>;
+    using redis_stream = tc_redis::redis_stream<redis_context_driver>;
+
+    //_tracerΪʱپÿ,ɵ÷֤
+    redis_context(redisContext* _context, redis_tracer* _tracer = nullptr) :context(_context), tracer(_tracer) {
     }
 
     redis_key key() {
-        return redis_key(context);
+        return redis_key(redis_context_driver(context, tracer));
     }
     redis_string string() {
-        return redis_string(context);
+        return redis_string(redis_context_driver(context, tracer));
     }
     redis_hash hash() {
-        return redis_hash(context);
+        return redis_hash(redis_context_driver(context, tracer));
     }
     redis_list list() {
-        return redis_list(context);
+        return redis_list(redis_context_driver(context, tracer));
     }
     redis_set set() {
-        return redis_set(context);
+        return redis_set(redis_context_driver(context, tracer));
     } 
     redis_sortedset sortedset() {
-        return redis_sortedset(context);
+        return redis_sortedset(redis_context_driver(context, tracer));
+    }
+    redis_stream stream() {
+        return redis_stream(redis_context_driver(context, tracer));
     }
 };
 
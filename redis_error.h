@@ -27,6 +27,8 @@ public:
 	DECLARE_REDIS_ERROR_CODE(test_failed);			//Ϊfalse
 	DECLARE_REDIS_ERROR_CODE(command_error);		//
 	DECLARE_REDIS_ERROR_CODE(exceeded_retry_times);	//
+	DECLARE_REDIS_ERROR_CODE(reply_not_ready);		//Ӧδ
+	DECLARE_REDIS_ERROR_CODE(pool_exhausted);		//ӳѺľ
 	//DECLARE_REDIS_ERROR_CODE(index_out_of_range);	//Խ
 	//DECLARE_REDIS_ERROR_CODE(object_locked);		//
 };
@@ -44,6 +46,7 @@ public:
 		const std::string& _describe = "",
 		const std::string& _cmd = "") :code(_code), describe(_describe), cmd(_cmd)
 	{
+		redis_metrics::count_error((const char*)code.get_value());
 	}
 	~redis_error() {}
 };
@@ -9,7 +9,11 @@
 
 
 #include <hiredis.h>
+#include <async.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <locale.h>
 #include <string>
 #include <deque>
 #include <vector>
@@ -19,17 +23,76 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <atomic>
 #include <sstream>
 #include <algorithm>
 #include <functional>
+#include <memory>
+#include <exception>
+#include <iterator>
+#include <tuple>
+#include <typeinfo>
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <string_view>
+#define REDIS_HAS_STRING_VIEW
+#include <charconv>
+#define REDIS_HAS_CHARCONV
+#if defined(__cpp_lib_to_chars)
+#define REDIS_HAS_FLOAT_CHARCONV
+#endif
+#endif
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#define REDIS_HAS_COROUTINE
+#endif
+
+#ifndef _WIN32
+#include <strings.h>
+#ifndef _stricmp
+#define _stricmp strcasecmp
+#endif
+#ifndef _strnicmp
+#define _strnicmp strncasecmp
+#endif
+#ifndef _snprintf
+#define _snprintf snprintf
+#endif
+#endif
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <errno.h>
+#include <unistd.h>
+#endif
 
 #include "va_wrap.h"
 
 #define TC_REDIS tc_redis
+#include "redis_metrics.h"
 #include "redis_error.h"
+#include "redis_command.h"
 #include "redis_reply.h"
+#include "redis_struct.h"
+#include "redis_trace.h"
 #include "redis_transaction.h"
 #include "redis_context.h"
+#include "redis_pipeline.h"
+#include "redis_connect.h"
+#include "redis_pool.h"
+#include "redis_async.h"
+#include "redis_cluster.h"
+#include "redis_scan.h"
+#include "redis_script.h"
+#include "redis_stream.h"
+#include "redis_subscriber.h"
+#include "redis_cache.h"
 
 
 #endif
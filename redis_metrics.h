@@ -0,0 +1,454 @@
+#pragma once
+
+#ifndef __REDIS_METRICS_H__
+#define __REDIS_METRICS_H__
+
+#ifdef TC_REDIS
+namespace TC_REDIS {
+#endif
+
+//һͳƿ,ʱ䵥λΪ
+struct redis_command_metrics {
+	std::string command;
+	uint64_t calls;
+	uint64_t errors;			//ӦΪ(Ӵ)error
+	uint64_t request_bytes;		//͵RESPֽ
+	uint64_t response_bytes;	//ӦRESPֽ
+	uint64_t total_ns;
+	uint64_t max_ns;
+	std::vector<uint64_t> histogram;	//Ͱļ,ͰĻּredis_metrics::bucket_lower
+
+	//λ(0~1)ĺʱ,ȡͰϽ,max_ns
+	uint64_t percentile(double _p)const;
+	uint64_t mean_ns()const { return calls == 0 ? 0 : total_ns / calls; }
+};
+
+//ͳƿ
+//ۼ,οõڵֵ
+struct redis_metrics_snapshot {
+	std::vector<redis_command_metrics> commands;				//
+	std::vector<std::pair<std::string, uint64_t>> errors;		//redis_error_code쳣
+	uint64_t watch_calls;
+	uint64_t watch_retries;		//redis_watchEXECnilԵĴ
+
+	//Prometheusıʽ
+	std::string to_text()const;
+};
+
+//ͳ
+//оredis_reply캯ͬͳƺʱֱͼ,󼰻Ӧֽ,
+//ͳredis_error쳣redis_watchԴ
+//̷߳Ƭ,ֻ߳д(relaxedĶд,ûԭӵĶд),ʱϲзƬ
+//ĬϹر,رʱÿֻһrelaxedһ֧,ʱ
+class redis_metrics
+{
+public:
+	//ֱͼ: 16nsÿһͰ,֮ÿ216Ͱ(1/16),Լ4.9Сʱ
+	enum { sub_buckets = 16, max_magnitude = 44, bucket_count = sub_buckets + (max_magnitude - 4) * sub_buckets };
+	enum { max_commands = 256, max_error_codes = 16 };
+
+	static bool enabled() { return flag().load(std::memory_order_relaxed); }
+	static void enable(bool _enable = true) { flag().store(_enable, std::memory_order_relaxed); }
+
+	static size_t bucket(uint64_t _ns)
+	{
+		if (_ns < sub_buckets) {
+			return (size_t)_ns;
+		}
+		size_t m = log2(_ns);
+		if (m >= max_magnitude) {
+			return bucket_count - 1;
+		}
+		return sub_buckets + (m - 4) * sub_buckets + (size_t)((_ns >> (m - 4)) - sub_buckets);
+	}
+
+	//Ͱ½,ϽΪһͰ½һ
+	static uint64_t bucket_lower(size_t _bucket)
+	{
+		if (_bucket < sub_buckets) {
+			return _bucket;
+		}
+		size_t m = (_bucket - sub_buckets) / sub_buckets + 4;
+		return (uint64_t)(sub_buckets + (_bucket - sub_buckets) % sub_buckets) << (m - 4);
+	}
+
+	//һļʱ,رʱʲôҲ
+	class scope
+	{
+	protected:
+		const std::string* cmd;
+		std::chrono::steady_clock::time_point start;
+	public:
+		explicit scope(const std::string& _cmd) :cmd(enabled() ? &_cmd : nullptr)
+		{
+			if (cmd != nullptr) {
+				start = std::chrono::steady_clock::now();
+			}
+		}
+
+		void done(size_t _request_bytes, const redisReply* _reply)
+		{
+			if (cmd != nullptr) {
+				uint64_t _ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+				record(*cmd, _ns, _request_bytes, _reply);
+			}
+		}
+	};
+
+	static void record(const std::string& _cmd, uint64_t _ns, size_t _request_bytes, const redisReply* _reply)
+	{
+		command_counters& _counters = local().command(command_index(_cmd));
+		add(_counters.calls, 1);
+		if (_reply == nullptr || _reply->type == REDIS_REPLY_ERROR) {
+			add(_counters.errors, 1);
+		}
+		add(_counters.request_bytes, _request_bytes);
+		add(_counters.response_bytes, _reply == nullptr ? 0 : resp_size(_reply));
+		add(_counters.total_ns, _ns);
+		if (_ns > _counters.max_ns.load(std::memory_order_relaxed)) {
+			_counters.max_ns.store(_ns, std::memory_order_relaxed);
+		}
+		add(_counters.histogram[bucket(_ns)], 1);
+	}
+
+	//_codeΪredis_error_code,ͬһ쳣ָͬ
+	static void count_error(const char* _code)
+	{
+		if (!enabled()) {
+			return;
+		}
+		shard& _shard = local();
+		for (size_t i = 0; i < max_error_codes; i++) {
+			const char* _slot = _shard.error_codes[i].load(std::memory_order_relaxed);
+			if (_slot == nullptr) {
+				_shard.error_codes[i].store(_code, std::memory_order_release);
+				_slot = _code;
+			}
+			if (_slot == _code) {
+				add(_shard.error_counts[i], 1);
+				return;
+			}
+		}
+	}
+
+	static void count_watch(bool _retry)
+	{
+		if (enabled()) {
+			add(local().watch_counts[_retry ? 1 : 0], 1);
+		}
+	}
+
+	static redis_metrics_snapshot snapshot()
+	{
+		redis_metrics_snapshot _snapshot;
+		_snapshot.watch_calls = 0;
+		_snapshot.watch_retries = 0;
+
+		registry& _registry = get_registry();
+		std::lock_guard<std::mutex> _lock(_registry.mutex);
+		size_t _command_count = _registry.command_count.load(std::memory_order_acquire);
+		std::vector<redis_command_metrics> _commands(_command_count);
+		for (size_t i = 0; i < _command_count; i++) {
+			_commands[i].command = _registry.names[i];
+			_commands[i].calls = _commands[i].errors = 0;
+			_commands[i].request_bytes = _commands[i].response_bytes = 0;
+			_commands[i].total_ns = _commands[i].max_ns = 0;
+			_commands[i].histogram.assign(bucket_count, 0);
+		}
+
+		std::map<std::string, uint64_t> _errors;
+		for (auto& _shard : _registry.shards) {
+			for (size_t i = 0; i < _command_count; i++) {
+				const command_counters* _counters = _shard->commands[i].load(std::memory_order_acquire);
+				if (_counters == nullptr) {
+					continue;
+				}
+				redis_command_metrics& _metrics = _commands[i];
+				_metrics.calls += _counters->calls.load(std::memory_order_relaxed);
+				_metrics.errors += _counters->errors.load(std::memory_order_relaxed);
+				_metrics.request_bytes += _counters->request_bytes.load(std::memory_order_relaxed);
+				_metrics.response_bytes += _counters->response_bytes.load(std::memory_order_relaxed);
+				_metrics.total_ns += _counters->total_ns.load(std::memory_order_relaxed);
+				_metrics.max_ns = std::max(_metrics.max_ns, _counters->max_ns.load(std::memory_order_relaxed));
+				for (size_t b = 0; b < bucket_count; b++) {
+					_metrics.histogram[b] += _counters->histogram[b].load(std::memory_order_relaxed);
+				}
+			}
+			for (size_t i = 0; i < max_error_codes; i++) {
+				const char* _code = _shard->error_codes[i].load(std::memory_order_acquire);
+				if (_code != nullptr) {
+					_errors[_code] += _shard->error_counts[i].load(std::memory_order_relaxed);
+				}
+			}
+			_snapshot.watch_calls += _shard->watch_counts[0].load(std::memory_order_relaxed);
+			_snapshot.watch_retries += _shard->watch_counts[1].load(std::memory_order_relaxed);
+		}
+
+		for (auto& _metrics : _commands) {
+			if (_metrics.calls != 0) {
+				_snapshot.commands.push_back(std::move(_metrics));
+			}
+		}
+		std::sort(_snapshot.commands.begin(), _snapshot.commands.end(),
+			[](const redis_command_metrics& a, const redis_command_metrics& b) { return a.command < b.command; });
+		_snapshot.errors.assign(_errors.begin(), _errors.end());
+		return _snapshot;
+	}
+protected:
+	struct command_counters {
+		std::atomic<uint64_t> calls;
+		std::atomic<uint64_t> errors;
+		std::atomic<uint64_t> request_bytes;
+		std::atomic<uint64_t> response_bytes;
+		std::atomic<uint64_t> total_ns;
+		std::atomic<uint64_t> max_ns;
+		std::atomic<uint64_t> histogram[bucket_count];
+
+		command_counters() :calls(0), errors(0), request_bytes(0), response_bytes(0), total_ns(0), max_ns(0)
+		{
+			for (auto& _count : histogram) {
+				_count.store(0, std::memory_order_relaxed);
+			}
+		}
+	};
+
+	//һ̵߳ļ,߳˳̸߳,
+	struct shard {
+		std::atomic<command_counters*> commands[max_commands];	//,ʱȡ
+		std::atomic<const char*> error_codes[max_error_codes];
+		std::atomic<uint64_t> error_counts[max_error_codes];
+		std::atomic<uint64_t> watch_counts[2];					//,
+		bool in_use;
+
+		shard() :in_use(true)
+		{
+			for (auto& _counters : commands) {
+				_counters.store(nullptr, std::memory_order_relaxed);
+			}
+			for (size_t i = 0; i < max_error_codes; i++) {
+				error_codes[i].store(nullptr, std::memory_order_relaxed);
+				error_counts[i].store(0, std::memory_order_relaxed);
+			}
+			watch_counts[0].store(0, std::memory_order_relaxed);
+			watch_counts[1].store(0, std::memory_order_relaxed);
+		}
+		~shard()
+		{
+			for (auto& _counters : commands) {
+				delete _counters.load(std::memory_order_relaxed);
+			}
+		}
+
+		command_counters& command(size_t i)
+		{
+			command_counters* _counters = commands[i].load(std::memory_order_relaxed);
+			if (_counters == nullptr) {
+				_counters = new command_counters();
+				commands[i].store(_counters, std::memory_order_release);
+			}
+			return *_counters;
+		}
+	};
+
+	//зƬ,ֻ,߳״μʱ
+	//ʱһ"*"
+	struct registry {
+		std::mutex mutex;
+		std::string names[max_commands];
+		std::atomic<size_t> command_count;
+		std::vector<std::unique_ptr<shard>> shards;
+
+		registry() :command_count(0) {}
+	};
+
+	//߳˳ʱ黹Ƭ
+	struct shard_holder {
+		shard* owned;
+
+		shard_holder() :owned(nullptr) {}
+		~shard_holder()
+		{
+			if (owned != nullptr) {
+				std::lock_guard<std::mutex> _lock(get_registry().mutex);
+				owned->in_use = false;
+			}
+		}
+	};
+
+	static std::atomic<bool>& flag() {
+		static std::atomic<bool> _enabled(false);
+		return _enabled;
+	}
+
+	static registry& get_registry() {
+		static registry* _registry = new registry();	//,߳˳ʱԿɷ
+		return *_registry;
+	}
+
+	//һдߵļ,ҪԭӵĶд
+	static void add(std::atomic<uint64_t>& _counter, uint64_t _v) {
+		_counter.store(_counter.load(std::memory_order_relaxed) + _v, std::memory_order_relaxed);
+	}
+
+	static size_t log2(uint64_t v)
+	{
+		size_t n = 0;
+		if (v >> 32) { v >>= 32; n += 32; }
+		if (v >> 16) { v >>= 16; n += 16; }
+		if (v >> 8) { v >>= 8; n += 8; }
+		if (v >> 4) { v >>= 4; n += 4; }
+		if (v >> 2) { v >>= 2; n += 2; }
+		if (v >> 1) { n += 1; }
+		return n;
+	}
+
+	static shard& local()
+	{
+		static thread_local shard_holder _holder;
+		if (_holder.owned == nullptr) {
+			registry& _registry = get_registry();
+			std::lock_guard<std::mutex> _lock(_registry.mutex);
+			for (auto& _shard : _registry.shards) {
+				if (!_shard->in_use) {
+					_shard->in_use = true;
+					_holder.owned = _shard.get();
+					break;
+				}
+			}
+			if (_holder.owned == nullptr) {
+				_registry.shards.emplace_back(new shard());
+				_holder.owned = _registry.shards.back().get();
+			}
+		}
+		return *_holder.owned;
+	}
+
+	//±,ÿ̻߳һ
+	static size_t command_index(const std::string& _cmd)
+	{
+		static thread_local std::unordered_map<std::string, size_t> _cache;
+		auto it = _cache.find(_cmd);
+		if (it != _cache.end()) {
+			return it->second;
+		}
+
+		registry& _registry = get_registry();
+		std::lock_guard<std::mutex> _lock(_registry.mutex);
+		size_t _count = _registry.command_count.load(std::memory_order_relaxed);
+		size_t i = 0;
+		while (i < _count && _registry.names[i] != _cmd) {
+			i++;
+		}
+		if (i == _count) {
+			if (_count < max_commands - 1) {
+				_registry.names[i] = _cmd;
+			}
+			else {
+				i = max_commands - 1;
+				_registry.names[i] = "*";
+			}
+			_registry.command_count.store(i + 1, std::memory_order_release);
+		}
+		_cache.emplace(_cmd, i);
+		return i;
+	}
+
+	static uint64_t digits(uint64_t v)
+	{
+		uint64_t n = 1;
+		while (v >= 10) {
+			v /= 10;
+			n++;
+		}
+		return n;
+	}
+
+	//ӦRESPֽ
+	static uint64_t resp_size(const redisReply* _reply)
+	{
+		switch (_reply->type)
+		{
+		case REDIS_REPLY_INTEGER:
+			return 3 + digits(_reply->integer < 0 ? 0 - (uint64_t)_reply->integer : (uint64_t)_reply->integer) + (_reply->integer < 0 ? 1 : 0);
+		case REDIS_REPLY_NIL:
+			return 5;
+		case REDIS_REPLY_STRING:
+			return 5 + digits(_reply->len) + _reply->len;
+		default:
+			break;
+		}
+		if (_reply->element == nullptr) {
+			return 3 + _reply->len;	//״̬,RESP3
+		}
+		uint64_t _size = 3 + digits(_reply->elements);
+		for (size_t i = 0; i < _reply->elements; i++) {
+			_size += resp_size(_reply->element[i]);
+		}
+		return _size;
+	}
+};
+
+inline uint64_t redis_command_metrics::percentile(double _p)const
+{
+	uint64_t _total = 0;
+	for (auto _count : histogram) {
+		_total += _count;
+	}
+	if (_total == 0) {
+		return 0;
+	}
+	uint64_t _rank = (uint64_t)(_p * (double)_total + 0.5);
+	_rank = std::max<uint64_t>(1, std::min(_rank, _total));
+	uint64_t _seen = 0;
+	for (size_t b = 0; b < histogram.size(); b++) {
+		_seen += histogram[b];
+		if (_seen >= _rank) {
+			uint64_t _upper = b + 1 < (size_t)redis_metrics::bucket_count ? redis_metrics::bucket_lower(b + 1) - 1 : max_ns;
+			return std::min(_upper, max_ns);
+		}
+	}
+	return max_ns;
+}
+
+inline std::string redis_metrics_snapshot::to_text()const
+{
+	static const double _quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+	std::ostringstream _out;
+	for (auto& _metrics : commands) {
+		std::string _label = "{command=\"" + _metrics.command + "\"";
+		_out << "redis_command_calls_total" << _label << "} " << _metrics.calls << "\n";
+		_out << "redis_command_errors_total" << _label << "} " << _metrics.errors << "\n";
+		_out << "redis_command_request_bytes_total" << _label << "} " << _metrics.request_bytes << "\n";
+		_out << "redis_command_response_bytes_total" << _label << "} " << _metrics.response_bytes << "\n";
+		for (double _q : _quantiles) {
+			_out << "redis_command_latency_seconds" << _label << ",quantile=\"" << _q << "\"} " << _metrics.percentile(_q) / 1e9 << "\n";
+		}
+		_out << "redis_command_latency_seconds_sum" << _label << "} " << _metrics.total_ns / 1e9 << "\n";
+		_out << "redis_command_latency_seconds_count" << _label << "} " << _metrics.calls << "\n";
+		_out << "redis_command_latency_seconds_max" << _label << "} " << _metrics.max_ns / 1e9 << "\n";
+	}
+	for (auto& _error : errors) {
+		_out << "redis_errors_total{code=\"" << _error.first << "\"} " << _error.second << "\n";
+	}
+	_out << "redis_watch_calls_total " << watch_calls << "\n";
+	_out << "redis_watch_retries_total " << watch_retries << "\n";
+	return _out.str();
+}
+
+/*
+	һ򵥵
+
+	tc_redis::redis_metrics::enable();
+	...
+	auto _snapshot = tc_redis::redis_metrics::snapshot();
+	for (auto& _command : _snapshot.commands) {
+		printf("%s calls=%llu p99=%lluns\n", _command.command.c_str(), _command.calls, _command.percentile(0.99));
+	}
+	std::string _text = _snapshot.to_text();	//Prometheusıʽ
+*/
+
+#ifdef TC_REDIS
+}
+#endif
+
+#endif
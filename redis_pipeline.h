@@ -0,0 +1,225 @@
+#pragma once
+
+#ifndef __REDIS_PIPELINE_H__
+#define __REDIS_PIPELINE_H__
+
+#ifdef TC_REDIS
+namespace TC_REDIS {
+#endif
+
+//ܵеĻӦ״̬
+class redis_future_state_base
+{
+protected:
+	bool ready;
+	std::exception_ptr error;
+public:
+	redis_future_state_base() :ready(false) {}
+	virtual ~redis_future_state_base() {}
+
+	//յӦ,תĿ
+	virtual void resolve(const redis_reply& _reply) = 0;
+
+	//ִʧ
+	void reject(std::exception_ptr _error) {
+		error = _error;
+		ready = true;
+	}
+
+	bool is_ready()const { return ready; }
+};
+
+template<typename T>
+class redis_future_state : public redis_future_state_base
+{
+protected:
+	T value;
+public:
+	T& get()
+	{
+		redis_test(ready, redis_error_code::reply_not_ready);
+		if (error) {
+			std::rethrow_exception(error);
+		}
+		return value;
+	}
+};
+
+//תĻӦ״̬
+//תʧʱ쳣״̬,get()ʱ׳
+template<typename CONVERT>
+class redis_future_task : public redis_future_state<typename CONVERT::result_type>
+{
+protected:
+	CONVERT convert;
+public:
+	redis_future_task(const CONVERT& _convert) :convert(_convert) {}
+
+	virtual void resolve(const redis_reply& _reply)
+	{
+		try {
+			this->value = convert(_reply);
+			this->ready = true;
+		}
+		catch (...) {
+			this->reject(std::current_exception());
+		}
+	}
+};
+
+//ܵӳٽ
+//flush֮ſget(),Ĵget()ʱ׳
+template<typename T>
+class redis_future
+{
+protected:
+	std::shared_ptr<redis_future_state<T>> state;
+public:
+	redis_future() {}
+	redis_future(const std::shared_ptr<redis_future_state<T>>& _state) :state(_state) {}
+
+	bool valid()const { return state != nullptr; }
+	bool ready()const { return state && state->is_ready(); }
+
+	T& get()
+	{
+		redis_test(valid(), redis_error_code::reply_not_ready);
+		return state->get();
+	}
+};
+
+class redis_pipeline;
+
+//ܵ,ֻ׷Ӳȴ,redis_future
+class redis_pipeline_driver
+{
+protected:
+	redis_pipeline* pipeline;
+public:
+	template<typename T> using result = redis_future<T>;
+
+	redis_pipeline_driver(redis_pipeline* _pipeline) :pipeline(_pipeline) {
+	}
+
+	template<typename CONVERT, typename... ARGS>
+	redis_future<typename CONVERT::result_type> command(const CONVERT& _convert, const std::string& _cmd, ARGS&&... _args);
+};
+
+//redisܵ
+//ṩredis_contextͬӿ,׷ӵӵ
+//flushʱһԷ,ٰ˳ȡлӦӦredis_future
+class redis_pipeline
+{
+protected:
+	struct pending_command {
+		std::string cmd;
+		std::shared_ptr<redis_future_state_base> state;
+	};
+
+	redisContext* context;
+	std::vector<pending_command> commands;
+
+	redis_pipeline(const redis_pipeline&) = delete;
+	redis_pipeline& operator =(const redis_pipeline&) = delete;
+public:
+	redis_pipeline(redisContext* _context) :
+		context(_context)
+	{
+	}
+	//δflushѾӵĻ,߻Ӧ,ӻ
+	~redis_pipeline()
+	{
+		try {
+			flush();
+		}
+		catch (...) {
+		}
+	}
+
+	//ʹò׷
+	//_convertѻӦתɽ
+	template<typename CONVERT, typename... ARGS>
+	redis_future<typename CONVERT::result_type> append(const CONVERT& _convert, const std::string& _cmd, ARGS&&... _args)
+	{
+		auto _state = std::make_shared<redis_future_task<CONVERT>>(_convert);
+		pending_command _pending;
+		_pending.cmd = redis_append_command(context, _cmd, std::forward<ARGS>(_args)...);
+		_pending.state = _state;
+		commands.push_back(std::move(_pending));
+		return redis_future<typename CONVERT::result_type>(_state);
+	}
+
+	//׷ӵûȡػӦ
+	size_t size()const { return commands.size(); }
+
+	//˳ȡػӦ
+	//Ĵ󱣴ڸԵredis_future
+	//Ӵʱʣredis_futureȫʧ,׳쳣
+	void flush()
+	{
+		std::vector<pending_command> _commands;
+		_commands.swap(commands);
+
+		for (size_t i = 0; i < _commands.size(); i++)
+		{
+			try {
+				redis_reply _reply = redis_get_reply(context, _commands[i].cmd);
+				_commands[i].state->resolve(_reply);
+			}
+			catch (...) {
+				auto _error = std::current_exception();
+				for (size_t j = i; j < _commands.size(); j++) {
+					_commands[j].state->reject(_error);
+				}
+				throw;
+			}
+		}
+	}
+
+	redis_key<redis_pipeline_driver> key() {
+		return redis_key<redis_pipeline_driver>(this);
+	}
+	redis_string<redis_pipeline_driver> string() {
+		return redis_string<redis_pipeline_driver>(this);
+	}
+	redis_hash<redis_pipeline_driver> hash() {
+		return redis_hash<redis_pipeline_driver>(this);
+	}
+	redis_list<redis_pipeline_driver> list() {
+		return redis_list<redis_pipeline_driver>(this);
+	}
+	redis_set<redis_pipeline_driver> set() {
+		return redis_set<redis_pipeline_driver>(this);
+	}
+	redis_sortedset<redis_pipeline_driver> sortedset() {
+		return redis_sortedset<redis_pipeline_driver>(this);
+	}
+	redis_stream<redis_pipeline_driver> stream() {
+		return redis_stream<redis_pipeline_driver>(this);
+	}
+};
+
+template<typename CONVERT, typename... ARGS>
+redis_future<typename CONVERT::result_type> redis_pipeline_driver::command(const CONVERT& _convert, const std::string& _cmd, ARGS&&... _args) {
+	return pipeline->append(_convert, _cmd, std::forward<ARGS>(_args)...);
+}
+
+/*
+	һ򵥵
+
+	redis_pipeline _pipeline(_context);
+	auto _count = _pipeline.string().INCR(_key);
+	auto _value = _pipeline.string().GET(_key2);
+	_pipeline.flush();
+
+	int64_t count = _count.get();
+	if (_value.get()) {
+		...
+	}
+*/
+
+#ifdef TC_REDIS
+}
+#endif
+
+#endif
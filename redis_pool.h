@@ -0,0 +1,253 @@
+#pragma once
+
+#ifndef __REDIS_POOL_H__
+#define __REDIS_POOL_H__
+
+#ifdef TC_REDIS
+namespace TC_REDIS {
+#endif
+
+class redis_pool;
+
+//ӳԼ
+//ʱԶ黹,ڼredis_contextһʹ
+class redis_pool_lease : public redis_context
+{
+protected:
+	friend class redis_pool;
+	redis_pool* pool;
+	size_t index;
+
+	redis_pool_lease(redis_pool* _pool, size_t _index, redisContext* _context) :
+		redis_context(_context), pool(_pool), index(_index)
+	{
+	}
+
+	redis_pool_lease(const redis_pool_lease&) = delete;
+	redis_pool_lease& operator =(const redis_pool_lease&) = delete;
+public:
+	redis_pool_lease(redis_pool_lease&& _lease) :
+		redis_context(_lease.context), pool(_lease.pool), index(_lease.index)
+	{
+		_lease.pool = nullptr;
+		_lease.context = nullptr;
+	}
+	~redis_pool_lease() { release(); }
+
+	redis_pool_lease& operator =(redis_pool_lease&& _lease)
+	{
+		std::swap(context, _lease.context);
+		std::swap(pool, _lease.pool);
+		std::swap(index, _lease.index);
+		return *this;
+	}
+
+	//õhiredis,redis_pipeline,redis_transaction
+	redisContext* get()const { return context; }
+
+	//ǰ黹
+	inline void release();
+};
+
+//redisӳ
+//й̶hiredis,acquire()һ
+//ÿ߳ϴʹõ,޳ͻʱֻҪһCAS,
+//Ӻľʱȴָʱ,ӶϿ´ʱ
+class redis_pool
+{
+protected:
+	friend class redis_pool_lease;
+
+	struct slot {
+		std::atomic<bool> busy;
+		redisContext* context;
+		std::chrono::steady_clock::time_point last_used;
+
+		slot() :busy(false), context(nullptr) {}
+	};
+
+	//߳ϴõ
+	struct affinity {
+		const redis_pool* pool;
+		size_t index;
+	};
+
+	std::function<redisContext*()> connect;
+	std::unique_ptr<slot[]> slots;
+	size_t count;
+	std::chrono::milliseconds health_check_interval;
+
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::atomic<size_t> waiters;
+
+	static affinity& local_affinity() {
+		static thread_local affinity _affinity = { nullptr, 0 };
+		return _affinity;
+	}
+
+	//ԤҲseq_cst,release()дbusyٶwaiters,ȴܿɵbusy
+	bool try_lock(size_t _index) {
+		bool _busy = false;
+		return !slots[_index].busy.load(std::memory_order_seq_cst)
+			&& slots[_index].busy.compare_exchange_strong(_busy, true);
+	}
+
+	//ȳԱ߳ϴε,ٴ߳صλÿʼһ
+	bool try_acquire(size_t& _index)
+	{
+		affinity& _affinity = local_affinity();
+		//ӳؿܸӳصĵַ,±Ҫټһ
+		if (_affinity.pool == this && _affinity.index < count && try_lock(_affinity.index)) {
+			_index = _affinity.index;
+			return true;
+		}
+
+		size_t _start = std::hash<std::thread::id>()(std::this_thread::get_id()) % count;
+		for (size_t i = 0; i < count; i++) {
+			size_t _i = (_start + i) % count;
+			if (try_lock(_i)) {
+				_affinity.pool = this;
+				_affinity.index = _i;
+				_index = _i;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void free_context(slot& _slot)
+	{
+		if (_slot.context != nullptr) {
+			redisFree(_slot.context);
+			_slot.context = nullptr;
+		}
+	}
+
+	//ӳʱPINGʧʱ
+	void prepare(slot& _slot)
+	{
+		if (_slot.context != nullptr && _slot.context->err) {
+			free_context(_slot);
+		}
+
+		if (_slot.context != nullptr && health_check_interval.count() > 0
+			&& std::chrono::steady_clock::now() - _slot.last_used > health_check_interval)
+		{
+			redis_reply _reply(_slot.context, "PING");
+			redisReply* _ping = _reply;
+			if (_ping == nullptr || _ping->type == REDIS_REPLY_ERROR) {
+				free_context(_slot);
+			}
+		}
+
+		if (_slot.context == nullptr) {
+			_slot.context = connect();
+			if (_slot.context != nullptr && _slot.context->err) {
+				std::string _describe = _slot.context->errstr;
+				free_context(_slot);
+				throw redis_error(redis_error_code::command_error, _describe, "CONNECT");
+			}
+			redis_test(_slot.context != nullptr, redis_error_code::command_error, "CONNECT");
+		}
+	}
+
+	void release(size_t _index)
+	{
+		slots[_index].last_used = std::chrono::steady_clock::now();
+		slots[_index].busy.store(false);
+		if (waiters.load() > 0) {
+			std::lock_guard<std::mutex> _lock(mutex);
+			cond.notify_one();
+		}
+	}
+
+	redis_pool(const redis_pool&) = delete;
+	redis_pool& operator =(const redis_pool&) = delete;
+public:
+	//_connect𴴽һõ(AUTH,SELECT),ʧܷnullptrerr
+	//_health_check_interval: ӿгʱ,ǰPINGһ,0ʾ
+	redis_pool(std::function<redisContext*()> _connect, size_t _count,
+		std::chrono::milliseconds _health_check_interval = std::chrono::milliseconds(30000)) :
+		connect(_connect), slots(new slot[_count]), count(_count),
+		health_check_interval(_health_check_interval), waiters(0)
+	{
+		redis_test(_count > 0);
+	}
+
+	redis_pool(const std::string& _host, int _port, size_t _count,
+		std::chrono::milliseconds _timeout = std::chrono::milliseconds(1000),
+		std::chrono::milliseconds _health_check_interval = std::chrono::milliseconds(30000)) :
+		redis_pool(redis_connector(_host, _port, _timeout), _count, _health_check_interval)
+	{
+	}
+
+	//Լӳ
+	~redis_pool()
+	{
+		for (size_t i = 0; i < count; i++) {
+			free_context(slots[i]);
+		}
+	}
+
+	size_t size()const { return count; }
+
+	//һ,Ӻľʱȴ_timeout,ʱ׳pool_exhausted
+	redis_pool_lease acquire(std::chrono::milliseconds _timeout = std::chrono::milliseconds(1000))
+	{
+		size_t _index = 0;
+		if (!try_acquire(_index))
+		{
+			auto _deadline = std::chrono::steady_clock::now() + _timeout;
+			std::unique_lock<std::mutex> _lock(mutex);
+			waiters++;
+			while (!try_acquire(_index)) {
+				if (cond.wait_until(_lock, _deadline) == std::cv_status::timeout && !try_acquire(_index)) {
+					waiters--;
+					throw redis_error(redis_error_code::pool_exhausted,
+						redis_error_code(redis_error_code::pool_exhausted).get_describe());
+				}
+			}
+			waiters--;
+		}
+
+		try {
+			prepare(slots[_index]);
+		}
+		catch (...) {
+			release(_index);
+			throw;
+		}
+		return redis_pool_lease(this, _index, slots[_index].context);
+	}
+};
+
+inline void redis_pool_lease::release()
+{
+	if (pool != nullptr) {
+		pool->release(index);
+		pool = nullptr;
+		context = nullptr;
+	}
+}
+
+/*
+	һ򵥵
+
+	redis_pool _pool("127.0.0.1", 6379, 16);
+
+	//ÿ߳
+	{
+		auto _lease = _pool.acquire();
+		auto value = _lease.string().GET(_key);
+
+		redis_pipeline _pipeline(_lease.get());
+		...
+	}
+*/
+
+#ifdef TC_REDIS
+}
+#endif
+
+#endif
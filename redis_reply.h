@@ -7,26 +7,6 @@
 namespace TC_REDIS {
 #endif
 
-//redisĲ
-//һʹ(%lld)
-//һʹ(%f)
-//ַ(%s)
-class redis_reply_param_type {
-public:
-	template<typename T>
-	typename std::enable_if<std::is_integral<typename std::decay<T>::type>::value 
-		|| std::is_enum<typename std::decay<T>::type>::value, const char*>::type
-		operator ()(T) { return "%lld"; }
-
-	template<typename T>
-	typename std::enable_if<std::is_floating_point<typename std::decay<T>::type>::value,
-		const char*>::type
-		operator ()(T) { return "%f"; }
-
-	const char* operator ()(const char*) { return "%s"; }
-	const char* operator ()(const std::string&) { return "%s"; }
-};
-
 //תredisĲ
 //һת(int64_t)
 //һת(double)
@@ -48,29 +28,59 @@ public:
 };
 
 
-//жϲǷstd::vector<std::string>
-template<typename... ARGS>
-class is_redis_command_argv {
-public:
-	enum { value = false };
-};
+//ıļ¼
+//lazy: Ĭֻ¼,ִʧܻreplyΪerrorʱȾ
+//always: ÿȾı(Ϊ,ڵ)
+//ͨ REDIS_COMMAND_CAPTURE_DEFAULT ڱָĬϲ
+#ifndef REDIS_COMMAND_CAPTURE_DEFAULT
+#define REDIS_COMMAND_CAPTURE_DEFAULT lazy
+#endif
 
-template<>
-class is_redis_command_argv<std::vector<std::string>> {
+class redis_command_capture {
 public:
-	enum { value = true };
+	enum policy { lazy, always };
+
+	static void set(policy _policy) { current().store(_policy, std::memory_order_relaxed); }
+	static policy get() { return (policy)current().load(std::memory_order_relaxed); }
+
+	//ݲԼִнжǷҪȾ
+	static bool need_render(bool _failed) { return _failed || get() == always; }
+protected:
+	static std::atomic<int>& current() {
+		static std::atomic<int> _policy(REDIS_COMMAND_CAPTURE_DEFAULT);
+		return _policy;
+	}
 };
 
+//Ⱦı,ڴϢ
+template<typename... ARGS, typename = typename std::enable_if<!is_redis_command_argv<typename std::decay<ARGS>::type...>::value>::type>
+std::string redis_command_render(const std::string& _cmd, ARGS&&... _args)
+{
+	std::string _text = _cmd;
+	int tmp[] = { 0, ((_text += ' ') += redis_command_text()(_args), 0)... };
+	(void)tmp;//for warning
+	return _text;
+}
+
+inline std::string redis_command_render(const std::string& _cmd, const std::vector<std::string>& argv)
+{
+	std::string _text = _cmd;
+	for (auto& _arg : argv) {
+		_text += ' ';
+		_text += _arg;
+	}
+	return _text;
+}
+
 //ʹòݹredis
-template<typename... ARGS, typename = std::enable_if<!is_redis_command_argv<typename std::decay<ARGS>::type...>::value>::type>
+template<typename... ARGS, typename = typename std::enable_if<!is_redis_command_argv<typename std::decay<ARGS>::type...>::value>::type>
 std::string redis_append_command(redisContext* _context, const std::string& _cmd, ARGS&&... _args)
 {
-	std::ostringstream _sout;
-	_sout << _cmd;
-	std::ostream* tmp[] = { &_sout, &(_sout << ' ' << redis_reply_param_type()(_args))... };
-	(void)tmp;//for warning
-	int ret = redisAppendCommand(_context, _sout.str().c_str(), redis_reply_param_convert()(_args)...);
-	std::string cmd = strprintf(_sout.str(), redis_reply_param_convert()(_args)...);
+	redis_command_writer _writer;
+	_writer.command(_cmd, _args...);
+	int ret = redisAppendFormattedCommand(_context, _writer.data(), _writer.size());
+	std::string cmd = redis_command_capture::need_render(ret != REDIS_OK) ?
+		redis_command_render(_cmd, _args...) : _cmd;
 	redis_test(ret == REDIS_OK, redis_error_code::command_error, cmd);
 	return cmd;
 }
@@ -78,50 +88,159 @@ std::string redis_append_command(redisContext* _context, const std::string& _cmd
 //ʹstd::vector<std::string>redis
 inline std::string redis_append_command(redisContext* _context, const std::string& _cmd, const std::vector<std::string>& argv)
 {
-	std::ostringstream _sout;
-	std::vector<const char*> _argv;
-	std::vector<size_t> _argvlen;
-	_sout << _cmd;
-	_argv.push_back(_cmd.c_str());
-	_argvlen.push_back(_cmd.size());
-	for (auto& _arg : argv) {
-		_sout << ' ' << _arg;
-		_argv.push_back(_arg.c_str());
-		_argvlen.push_back(_arg.size());
-	}
-	int ret = redisAppendCommandArgv(_context, _argv.size(), _argv.data(), _argvlen.data());
-	std::string cmd = _sout.str();
+	redis_command_writer _writer;
+	_writer.command(_cmd, argv);
+	int ret = redisAppendFormattedCommand(_context, _writer.data(), _writer.size());
+	std::string cmd = redis_command_capture::need_render(ret != REDIS_OK) ?
+		redis_command_render(_cmd, argv) : _cmd;
 	redis_test(ret == REDIS_OK, redis_error_code::command_error, cmd);
 	return cmd;
 }
 
+//redisصĸı(inf,-inf)
+//15λЧûָʱβֱӼ,strtodһ
+//ཻstd::from_chars(޹),ָ֧from_charsʱstrtod
+inline bool redis_parse_double(const char* _str, size_t _len, double& _v)
+{
+	static const double _pow10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+	};
+
+	const char* p = _str;
+	const char* end = _str + _len;
+	bool _negative = (p < end && *p == '-');
+	if (p < end && (*p == '-' || *p == '+')) {
+		p++;
+	}
+
+	uint64_t _mantissa = 0;
+	int _digits = 0;
+	int _fraction = 0;
+	bool _dot = false;
+	for (; p < end; p++) {
+		if (*p >= '0' && *p <= '9') {
+			if (++_digits > 15) {
+				break;
+			}
+			_mantissa = _mantissa * 10 + (*p - '0');
+			_fraction += _dot ? 1 : 0;
+		}
+		else if (*p == '.' && !_dot) {
+			_dot = true;
+		}
+		else {
+			break;
+		}
+	}
+	if (p == end && _digits > 0) {
+		_v = (double)_mantissa / _pow10[_fraction];
+		_v = _negative ? -_v : _v;
+		return true;
+	}
+
+#ifdef REDIS_HAS_FLOAT_CHARCONV
+	//from_chars'+'
+	const char* _begin = (_len > 0 && *_str == '+') ? _str + 1 : _str;
+	auto _r = std::from_chars(_begin, end, _v);
+	return _r.ec == std::errc() && _r.ptr == end;
+#else
+	char _buf[64];
+	std::string _long;
+	const char* _text = _buf;
+	if (_len < sizeof(_buf)) {
+		memcpy(_buf, _str, _len);
+		_buf[_len] = 0;
+	}
+	else {
+		_long.assign(_str, _len);
+		_text = _long.c_str();
+	}
+	char* _end = nullptr;
+	_v = strtod(_text, &_end);
+	return _len > 0 && _end == _text + _len;
+#endif
+}
+
+//redisصʮ,ƥҲ
+inline bool redis_parse_int(const char* _str, size_t _len, int64_t& _v)
+{
+#ifdef REDIS_HAS_CHARCONV
+	auto _r = std::from_chars(_str, _str + _len, _v);
+	return _r.ec == std::errc() && _r.ptr == _str + _len;
+#else
+	const char* p = _str;
+	const char* end = _str + _len;
+	bool _negative = (p < end && *p == '-');
+	if (_negative) {
+		p++;
+	}
+	if (p == end) {
+		return false;
+	}
+
+	uint64_t _limit = _negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+	uint64_t _u = 0;
+	for (; p < end; p++) {
+		if (*p < '0' || *p > '9') {
+			return false;
+		}
+		uint64_t _digit = (uint64_t)(*p - '0');
+		if (_u > (_limit - _digit) / 10) {
+			return false;
+		}
+		_u = _u * 10 + _digit;
+	}
+	_v = _negative ? (int64_t)(0 - _u) : (int64_t)_u;
+	return true;
+#endif
+}
+
+//򼯺ϵĳԱ
+struct redis_scored_member {
+	std::string member;
+	double score;
+};
+
+//һĿ,ֶΰ˳;ѱɾڴȷбеĿûֶ
+struct redis_stream_entry {
+	redis_stream_id id;
+	std::vector<std::pair<std::string, std::string>> fields;
+};
+
+//XREAD/XREADGROUPһĽ
+typedef std::pair<std::string, std::vector<redis_stream_entry>> redis_stream_result;
+
+class redis_reply;
+
 //redisֵ
 //ṩstd::string,int64_t,doubleĶдӿ
+//ֱֵӸʽջϵĻٴvalue,ַ(ʵΪ15ֽ)ֵ
+//ȡܾȷ̱ʾ;as_int(),as_float()޹,ֵʱ׳reply_data_incorrect
 class redis_value {
 protected:
 	std::string value;
+
+	void assign(int64_t _v) {
+		char tmp[24];
+		value.assign(tmp, redis_command_writer::format_int(tmp, _v));
+	}
+	void assign(double _v) {
+		char tmp[32];
+		value.assign(tmp, redis_command_writer::format_double(tmp, _v));
+	}
+	void assign(const char* _v) {
+		value.assign(_v);
+	}
 public:
-	template<typename T, typename = std::enable_if <
+	template<typename T, typename = typename std::enable_if <
 		!std::is_same<typename std::decay<T>::type, redis_reply>::value,
-		std::result_of<redis_reply_param_convert(typename std::decay<T>::type)>::type
+		typename std::result_of<redis_reply_param_convert(typename std::decay<T>::type)>::type
 	>::type>
 	explicit redis_value(const T& _v)
 	{
-		auto _v2 = redis_reply_param_convert()(_v);
-
-		if (&typeid(int64_t) == &typeid(_v2)) {
-			value = strprintf("%I64d", _v2);
-		}
-		else if (&typeid(double) == &typeid(_v2)){
-			value = strprintf("%lf", _v2);
-		}
-		else if (&typeid(const char*) == &typeid(_v2)) {
-			value = strprintf("%s", _v2);
-		}
-		else {
-			redis_test(false);
-		}
+		assign(redis_reply_param_convert()(_v));
 	}
+	redis_value(const char* _str, size_t _len) :value(_str, _len) {}
 	redis_value() {}
 	redis_value(const redis_value& _v) { value = _v.value; }
 	redis_value(redis_value&& _v) { std::swap(value, _v.value); }
@@ -130,8 +249,18 @@ public:
 	operator const std::string&()const { return value; }
 
 	const std::string& as_string()const { return value; }
-	int64_t as_int()const { return atoll(value.c_str()); }
-	double as_float()const { return atof(value.c_str()); }
+	int64_t as_int()const
+	{
+		int64_t _v = 0;
+		redis_test(redis_parse_int(value.data(), value.size(), _v), redis_error_code::reply_data_incorrect);
+		return _v;
+	}
+	double as_float()const
+	{
+		double _v = 0;
+		redis_test(redis_parse_double(value.data(), value.size(), _v), redis_error_code::reply_data_incorrect);
+		return _v;
+	}
 
 	template<typename T>
 	redis_value& operator =(const T& _v) {
@@ -147,6 +276,442 @@ public:
 	}
 };
 
+#ifdef REDIS_HAS_STRING_VIEW
+//redisӦͼ
+//ֱӽredis_replyеredisReply,Ԫstd::string_view
+//,Ҳü,ڲܳredis_reply
+class redis_reply_view
+{
+protected:
+	const redisReply* reply;
+	const std::string* cmd;
+
+	const std::string& get_cmd()const {
+		static const std::string _empty;
+		return cmd ? *cmd : _empty;
+	}
+
+	//УǷerror
+	void check_error()const
+	{
+		redis_test(reply != nullptr, redis_error_code::reply_is_null, get_cmd());
+
+		if (reply->type == REDIS_REPLY_ERROR) {
+			throw redis_error(redis_error_code::reply_is_error, (reply->str ? reply->str : ""), get_cmd());
+		}
+	}
+
+	//Ҫreply
+	void check_array()const
+	{
+		check_error();
+		redis_test(reply->type == REDIS_REPLY_ARRAY, redis_error_code::reply_type_incorrect, get_cmd());
+	}
+public:
+	//Ԫص
+	class iterator
+	{
+	protected:
+		redisReply* const* element;
+		const std::string* cmd;
+	public:
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef redis_reply_view value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const redis_reply_view* pointer;
+		typedef redis_reply_view reference;
+
+		iterator(redisReply* const* _element, const std::string* _cmd) :element(_element), cmd(_cmd) {}
+
+		redis_reply_view operator *()const { return redis_reply_view(*element, cmd); }
+		redis_reply_view operator [](difference_type n)const { return redis_reply_view(element[n], cmd); }
+		iterator& operator ++() { ++element; return *this; }
+		iterator operator ++(int) { iterator _it = *this; ++element; return _it; }
+		iterator& operator --() { --element; return *this; }
+		iterator operator --(int) { iterator _it = *this; --element; return _it; }
+		iterator& operator +=(difference_type n) { element += n; return *this; }
+		iterator& operator -=(difference_type n) { element -= n; return *this; }
+		iterator operator +(difference_type n)const { return iterator(element + n, cmd); }
+		iterator operator -(difference_type n)const { return iterator(element - n, cmd); }
+		difference_type operator -(const iterator& _it)const { return element - _it.element; }
+		bool operator ==(const iterator& _it)const { return element == _it.element; }
+		bool operator !=(const iterator& _it)const { return element != _it.element; }
+		bool operator <(const iterator& _it)const { return element < _it.element; }
+	};
+
+	//(field, value)ɶԱ,HGETALL,WITHSCORESȻӦ
+	class pair_iterator
+	{
+	protected:
+		redisReply* const* element;
+		const std::string* cmd;
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef std::pair<redis_reply_view, redis_reply_view> value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const value_type* pointer;
+		typedef value_type reference;
+
+		pair_iterator(redisReply* const* _element, const std::string* _cmd) :element(_element), cmd(_cmd) {}
+
+		value_type operator *()const {
+			return value_type(redis_reply_view(element[0], cmd), redis_reply_view(element[1], cmd));
+		}
+		pair_iterator& operator ++() { element += 2; return *this; }
+		pair_iterator operator ++(int) { pair_iterator _it = *this; element += 2; return _it; }
+		bool operator ==(const pair_iterator& _it)const { return element == _it.element; }
+		bool operator !=(const pair_iterator& _it)const { return element != _it.element; }
+	};
+
+	class pair_range
+	{
+	protected:
+		pair_iterator first;
+		pair_iterator last;
+	public:
+		pair_range(const pair_iterator& _first, const pair_iterator& _last) :first(_first), last(_last) {}
+		pair_iterator begin()const { return first; }
+		pair_iterator end()const { return last; }
+	};
+
+	redis_reply_view(const redisReply* _reply = nullptr, const std::string* _cmd = nullptr) :
+		reply(_reply), cmd(_cmd)
+	{
+	}
+
+	const redisReply* get()const { return reply; }
+
+	bool is_nil()const
+	{
+		check_error();
+		return reply->type == REDIS_REPLY_NIL;
+	}
+
+	int type()const
+	{
+		check_error();
+		return reply->type;
+	}
+
+	std::string_view str()const
+	{
+		check_error();
+		redis_test(reply->type == REDIS_REPLY_STRING || reply->type == REDIS_REPLY_STATUS,
+			redis_error_code::reply_type_incorrect, get_cmd());
+		return std::string_view(reply->str, reply->len);
+	}
+	explicit operator std::string_view()const { return str(); }
+
+	int64_t integer()const
+	{
+		check_error();
+		redis_test(reply->type == REDIS_REPLY_INTEGER, redis_error_code::reply_type_incorrect, get_cmd());
+		return reply->integer;
+	}
+	explicit operator int64_t()const { return integer(); }
+
+	size_t size()const
+	{
+		check_array();
+		return reply->elements;
+	}
+
+	redis_reply_view operator [](size_t i)const
+	{
+		check_array();
+		redis_test(i < reply->elements, redis_error_code::reply_data_incorrect, get_cmd());
+		return redis_reply_view(reply->element[i], cmd);
+	}
+
+	iterator begin()const
+	{
+		check_array();
+		return iterator(reply->element, cmd);
+	}
+	iterator end()const
+	{
+		check_array();
+		return iterator(reply->element + reply->elements, cmd);
+	}
+
+	//ҪԪظż
+	pair_range pairs()const
+	{
+		check_array();
+		redis_test(reply->elements % 2 == 0, redis_error_code::reply_data_incorrect, get_cmd());
+		return pair_range(pair_iterator(reply->element, cmd),
+			pair_iterator(reply->element + reply->elements, cmd));
+	}
+};
+#endif
+
+//ԪתΪЩʱٳredis_reply,ֻøӦ
+template<typename T>
+class is_redis_reply_borrowable {
+public:
+	enum {
+		value = std::is_arithmetic<T>::value
+			|| std::is_same<T, std::string>::value
+			|| std::is_same<T, redis_value>::value
+	};
+};
+
+//Ӧķ
+//ͨredisReplyObjectFunctionsѻӦԪ˳ӳеڴ,ٴҲֻҪڴ
+//ϵredis_replyȫͷź,һӦͷЩڴ,max_retainedĿ黹ϵͳ
+//ͬ:ӵprivdata(ͷʱһͷ),RESP3pushϢֱӶ
+class redis_reply_arena
+{
+protected:
+	struct chunk {
+		char* data;
+		size_t size;
+	};
+
+	//ÿӦĸǰ¼ķ,ͷʱҪ
+	struct root_header {
+		redis_reply_arena* arena;
+		size_t reserved;
+	};
+
+	std::vector<chunk> chunks;
+	size_t current;		//ڷĿ
+	size_t offset;		//ǰѷֽ
+	size_t chunk_size;
+	size_t max_retained;
+	std::atomic<size_t> refs;	//ӳ1,ÿδͷŵĻӦ1
+
+	redis_reply_arena(size_t _chunk_size, size_t _max_retained) :
+		current(0), offset(0), chunk_size(_chunk_size), max_retained(_max_retained), refs(1)
+	{
+	}
+	~redis_reply_arena()
+	{
+		for (auto& _chunk : chunks) {
+			free(_chunk.data);
+		}
+	}
+
+	void unref()
+	{
+		if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			delete this;
+		}
+	}
+
+	void* allocate(size_t _size)
+	{
+		_size = (_size + 7) & ~(size_t)7;
+		while (current < chunks.size() && offset + _size > chunks[current].size) {
+			current++;
+			offset = 0;
+		}
+		if (current == chunks.size()) {
+			chunk _chunk = { (char*)malloc(std::max(chunk_size, _size)), std::max(chunk_size, _size) };
+			if (_chunk.data == nullptr) {
+				return nullptr;
+			}
+			chunks.push_back(_chunk);
+		}
+		void* p = chunks[current].data + offset;
+		offset += _size;
+		return p;
+	}
+
+	//ûδͷŵĻӦʱͷ,ֻmax_retainedڵĿ
+	void reset()
+	{
+		size_t _retained = 0;
+		size_t n = 0;
+		for (; n < chunks.size() && (n == 0 || _retained + chunks[n].size <= max_retained); n++) {
+			_retained += chunks[n].size;
+		}
+		for (size_t i = n; i < chunks.size(); i++) {
+			free(chunks[i].data);
+		}
+		chunks.resize(n);
+		current = 0;
+		offset = 0;
+	}
+
+	static redisReply* create(const redisReadTask* _task)
+	{
+		redis_reply_arena* _arena = (redis_reply_arena*)_task->privdata;
+		redisReply* r = nullptr;
+		if (_task->parent == nullptr) {
+			//ֻڽӦ߳Ϸ,ֻ߳,1ʱûδͷŵĻӦ
+			if (_arena->refs.load(std::memory_order_acquire) == 1) {
+				_arena->reset();
+			}
+			root_header* _header = (root_header*)_arena->allocate(sizeof(root_header) + sizeof(redisReply));
+			if (_header == nullptr) {
+				return nullptr;
+			}
+			_header->arena = _arena;
+			_arena->refs.fetch_add(1, std::memory_order_relaxed);
+			r = (redisReply*)(_header + 1);
+		}
+		else {
+			r = (redisReply*)_arena->allocate(sizeof(redisReply));
+			if (r == nullptr) {
+				return nullptr;
+			}
+		}
+		memset(r, 0, sizeof(redisReply));
+		r->type = _task->type;
+		if (_task->parent != nullptr) {
+			((redisReply*)_task->parent->obj)->element[_task->idx] = r;
+		}
+		return r;
+	}
+
+	static char* copy(const redisReadTask* _task, const char* _str, size_t _len)
+	{
+		char* _buf = (char*)((redis_reply_arena*)_task->privdata)->allocate(_len + 1);
+		if (_buf != nullptr) {
+			memcpy(_buf, _str, _len);
+			_buf[_len] = 0;
+		}
+		return _buf;
+	}
+
+	static void* create_string(const redisReadTask* _task, char* _str, size_t _len)
+	{
+		redisReply* r = create(_task);
+		if (r == nullptr) {
+			return nullptr;
+		}
+#ifdef REDIS_REPLY_VERB
+		if (_task->type == REDIS_REPLY_VERB && _len >= 4) {
+			memcpy(r->vtype, _str, 3);
+			r->vtype[3] = 0;
+			_str += 4;
+			_len -= 4;
+		}
+#endif
+		r->str = copy(_task, _str, _len);
+		r->len = _len;
+		return r->str != nullptr ? r : nullptr;
+	}
+
+	static void* create_array(const redisReadTask* _task, size_t _elements)
+	{
+		redisReply* r = create(_task);
+		if (r == nullptr) {
+			return nullptr;
+		}
+		if (_elements > 0) {
+			r->element = (redisReply**)((redis_reply_arena*)_task->privdata)->allocate(_elements * sizeof(redisReply*));
+			if (r->element == nullptr) {
+				return nullptr;
+			}
+			memset(r->element, 0, _elements * sizeof(redisReply*));
+		}
+		r->elements = _elements;
+		return r;
+	}
+
+	static void* create_integer(const redisReadTask* _task, long long _value)
+	{
+		redisReply* r = create(_task);
+		if (r != nullptr) {
+			r->integer = _value;
+		}
+		return r;
+	}
+
+	static void* create_double(const redisReadTask* _task, double _value, char* _str, size_t _len)
+	{
+		redisReply* r = create(_task);
+		if (r == nullptr) {
+			return nullptr;
+		}
+		r->dval = _value;
+		r->str = copy(_task, _str, _len);
+		r->len = _len;
+		return r->str != nullptr ? r : nullptr;
+	}
+
+	static void* create_nil(const redisReadTask* _task)
+	{
+		return create(_task);
+	}
+
+	static void* create_bool(const redisReadTask* _task, int _value)
+	{
+		redisReply* r = create(_task);
+		if (r != nullptr) {
+			r->integer = _value != 0;
+		}
+		return r;
+	}
+
+	static void free_object(void* _reply)
+	{
+		release((redisReply*)_reply);
+	}
+
+	static void free_push(void* /*_privdata*/, void* _reply)
+	{
+		release((redisReply*)_reply);
+	}
+
+	static void detach(void* _privdata)
+	{
+		((redis_reply_arena*)_privdata)->unref();
+	}
+public:
+	static redisReplyObjectFunctions* functions()
+	{
+		static redisReplyObjectFunctions _functions = {
+			create_string, create_array, create_integer, create_double, create_nil, create_bool, free_object
+		};
+		return &_functions;
+	}
+
+	//ͬ÷,ӵprivdataܱռ
+	//ٴεÿ
+	static void attach(redisContext* _context, size_t _chunk_size = 64 * 1024, size_t _max_retained = 1024 * 1024)
+	{
+		redis_test(_context != nullptr && _context->reader != nullptr, redis_error_code::command_error, "ARENA");
+		redis_test(_context->privdata == nullptr || _context->free_privdata == detach,
+			redis_error_code::command_error, "ARENA");
+
+		if (_context->privdata == nullptr) {
+			_context->privdata = new redis_reply_arena(_chunk_size, _max_retained);
+			_context->free_privdata = detach;
+		}
+		_context->reader->fn = functions();
+		_context->reader->privdata = _context->privdata;
+		redisSetPushCallback(_context, free_push);
+	}
+
+	//ӵǰǷʹ÷
+	static bool attached(const redisContext* _context)
+	{
+		return _context != nullptr && _context->reader != nullptr && _context->reader->fn == functions();
+	}
+
+	//ͷŷеһӦ
+	static void release(redisReply* _reply)
+	{
+		if (_reply != nullptr) {
+			((root_header*)_reply - 1)->arena->unref();
+		}
+	}
+
+	//ͷ϶ĻӦ,Ƿʹ÷ѡͷŷʽ
+	static void free_reply(const redisContext* _context, redisReply* _reply)
+	{
+		if (attached(_context)) {
+			release(_reply);
+		}
+		else if (_reply != nullptr) {
+			freeReplyObject(_reply);
+		}
+	}
+};
+
 //redisӦ
 //תĿʧʱ׳쳣
 class redis_reply
@@ -166,6 +731,22 @@ protected:
 		}
 	}
 
+	//תiԪ
+	//ĿͲٳredis_replyʱֻñӦ,ÿԪһü
+	template<typename T>
+	T convert_element(size_t i)const
+	{
+		static const std::shared_ptr<redisReply> _borrowed;
+		redis_reply _redis_reply(reply->element[i],
+			is_redis_reply_borrowable<T>::value ? _borrowed : ref_reply);
+		return (T)std::move(_redis_reply);
+	}
+
+	template<typename T>
+	static void reserve(std::vector<T>& _vector, size_t n) { _vector.reserve(n); }
+	template<typename T>
+	static void reserve(T&, size_t) {}
+
 	//תvectorʵ
 	template<typename T>
 	T convert_vector()const
@@ -175,9 +756,9 @@ protected:
 		redis_test(reply->type == REDIS_REPLY_ARRAY, redis_error_code::reply_type_incorrect, cmd);
 
 		T _vector;
+		reserve(_vector, reply->elements);
 		for (size_t i = 0; i < reply->elements; i++) {
-			redis_reply _redis_reply(reply->element[i], ref_reply);
-			_vector.push_back((typename T::value_type)std::move(_redis_reply));
+			_vector.push_back(convert_element<typename T::value_type>(i));
 		}
 		return _vector;
 	}
@@ -192,8 +773,7 @@ protected:
 
 		T _set;
 		for (size_t i = 0; i < reply->elements; i++) {
-			redis_reply _redis_reply(reply->element[i], ref_reply);
-			_set.insert((typename T::key_type)std::move(_redis_reply));
+			_set.insert(convert_element<typename T::key_type>(i));
 		}
 		return _set;
 	}
@@ -208,19 +788,69 @@ protected:
 		redis_test(reply->elements % 2 == 0, redis_error_code::reply_data_incorrect, cmd);
 
 		T _map;
-		for (size_t i = 0; i < reply->elements; i += 2)
-		{
-			typename T::key_type _field;
-			{
-				redis_reply _redis_reply(reply->element[i], ref_reply);
-				_field = (typename T::key_type)std::move(_redis_reply);
+		for (size_t i = 0; i < reply->elements; i += 2) {
+			_map[convert_element<typename T::key_type>(i)] = convert_element<typename T::mapped_type>(i + 1);
+		}
+		return _map;
+	}
+
+	//Ŀ,ֱֶӴӻӦĻ
+	void append_stream_entries(const redisReply* _entries, std::vector<redis_stream_entry>& _out)const
+	{
+		redis_test(_entries->type == REDIS_REPLY_ARRAY, redis_error_code::reply_type_incorrect, cmd);
+		_out.reserve(_out.size() + _entries->elements);
+		for (size_t i = 0; i < _entries->elements; i++) {
+			const redisReply* _entry = _entries->element[i];
+			redis_test(_entry->type == REDIS_REPLY_ARRAY && _entry->elements == 2
+				&& _entry->element[0]->type == REDIS_REPLY_STRING, redis_error_code::reply_type_incorrect, cmd);
+
+			_out.emplace_back();
+			redis_stream_entry& _item = _out.back();
+			redis_test(redis_stream_id::parse(_entry->element[0]->str, _entry->element[0]->len, _item.id),
+				redis_error_code::reply_data_incorrect, cmd);
+
+			const redisReply* _fields = _entry->element[1];
+			if (_fields->type == REDIS_REPLY_NIL) {
+				continue;
 			}
-			{
-				redis_reply _redis_reply(reply->element[i + 1], ref_reply);
-				_map[_field] = (typename T::mapped_type)std::move(_redis_reply);
+			bool _map = _fields->type == REDIS_REPLY_ARRAY;
+#ifdef REDIS_REPLY_MAP
+			_map = _map || _fields->type == REDIS_REPLY_MAP;
+#endif
+			redis_test(_map && _fields->elements % 2 == 0, redis_error_code::reply_type_incorrect, cmd);
+			_item.fields.reserve(_fields->elements / 2);
+			for (size_t j = 0; j < _fields->elements; j += 2) {
+				const redisReply* _field = _fields->element[j];
+				const redisReply* _value = _fields->element[j + 1];
+				redis_test(_field->type == REDIS_REPLY_STRING && _value->type == REDIS_REPLY_STRING,
+					redis_error_code::reply_type_incorrect, cmd);
+				_item.fields.emplace_back(std::piecewise_construct,
+					std::forward_as_tuple(_field->str, _field->len), std::forward_as_tuple(_value->str, _value->len));
 			}
 		}
-		return _map;
+	}
+
+	void append_stream(const redisReply* _key, const redisReply* _entries, std::vector<redis_stream_result>& _out)const
+	{
+		redis_test(_key->type == REDIS_REPLY_STRING, redis_error_code::reply_type_incorrect, cmd);
+		_out.emplace_back();
+		_out.back().first.assign(_key->str, _key->len);
+		append_stream_entries(_entries, _out.back().second);
+	}
+
+	//ִʧܻ߷˴
+	bool is_failed()const {
+		return reply == nullptr || reply->type == REDIS_REPLY_ERROR;
+	}
+
+	//ѱȴӦ,ʧܷnullptr
+	static redisReply* execute(redisContext* _context, const char* _data, size_t _size)
+	{
+		redisReply* _reply = nullptr;
+		if (redisAppendFormattedCommand(_context, _data, _size) == REDIS_OK) {
+			redisGetReply(_context, (void**)&_reply);
+		}
+		return _reply;
 	}
 
 	static void free_reply(redisReply* reply) {
@@ -229,6 +859,13 @@ protected:
 		}
 	}
 
+	//Ƿʹ÷ѡͷŷʽ
+	static std::shared_ptr<redisReply> make_ref(const redisContext* _context, redisReply* _reply) {
+		return redis_reply_arena::attached(_context) ?
+			std::shared_ptr<redisReply>(_reply, redis_reply_arena::release) :
+			std::shared_ptr<redisReply>(_reply, free_reply);
+	}
+
 	redis_reply(const redis_reply&) = delete;
 	redis_reply& operator =(const redis_reply&) = delete;
 public:
@@ -240,6 +877,11 @@ public:
 		reply(_reply), cmd(_cmd), ref_reply(_ref_reply)
 	{
 	}
+	//϶ĻӦ,Ƿʹ÷ѡͷŷʽ
+	redis_reply(const redisContext* _context, redisReply* _reply, const std::string& _cmd) :
+		reply(_reply), cmd(_cmd), ref_reply(make_ref(_context, _reply))
+	{
+	}
 	redis_reply(redis_reply&& _reply) :
 		reply(nullptr)
 	{
@@ -262,36 +904,44 @@ public:
 
 	const std::string& get_cmd() const { return cmd; }
 
+#ifdef REDIS_HAS_STRING_VIEW
+	//Ƶֻͼ,ڲܳӦ
+	redis_reply_view view()const { return redis_reply_view(reply, &cmd); }
+#endif
+
 	//ͨݷʽredis
-	template<typename... ARGS, typename = std::enable_if<!is_redis_command_argv<typename std::decay<ARGS>::type...>::value>::type>
-	redis_reply(redisContext* _context, const std::string& _cmd, ARGS&&... _args) 
+	//ֱӱRESP,Ĭֻ¼,ʧʱȾ(μredis_command_capture)
+	//redis_metricsʱͳƺʱֽ
+	template<typename... ARGS, typename = typename std::enable_if<!is_redis_command_argv<typename std::decay<ARGS>::type...>::value>::type>
+	redis_reply(redisContext* _context, const std::string& _cmd, ARGS&&... _args) :
+		reply(nullptr)
 	{
-		std::ostringstream _sout;
-		_sout << _cmd;
-		std::ostream* tmp[] = { &_sout, &(_sout << ' ' << redis_reply_param_type()(_args))... };
-		(void)tmp;//for warning
-		reply = (redisReply*)redisCommand(_context, _sout.str().c_str(), redis_reply_param_convert()(_args)...);
-		ref_reply.reset(reply, free_reply);
-		cmd = strprintf(_sout.str(), redis_reply_param_convert()(_args)...);
+		{
+			redis_command_writer _writer;
+			_writer.command(_cmd, _args...);
+			redis_metrics::scope _metrics(_cmd);
+			reply = execute(_context, _writer.data(), _writer.size());
+			_metrics.done(_writer.size(), reply);
+		}
+		ref_reply = make_ref(_context, reply);
+		cmd = redis_command_capture::need_render(is_failed()) ?
+			redis_command_render(_cmd, _args...) : _cmd;
 	}
 
 	//ͨstd::vector<std::string>ʽredis
-	redis_reply(redisContext* _context, const std::string& _cmd, const std::vector<std::string>& argv)
+	redis_reply(redisContext* _context, const std::string& _cmd, const std::vector<std::string>& argv) :
+		reply(nullptr)
 	{
-		std::ostringstream _sout;
-		std::vector<const char*> _argv;
-		std::vector<size_t> _argvlen;
-		_sout << _cmd;
-		_argv.push_back(_cmd.c_str());
-		_argvlen.push_back(_cmd.size());
-		for (auto& _arg : argv) {
-			_sout << ' ' << _arg;
-			_argv.push_back(_arg.c_str());
-			_argvlen.push_back(_arg.size());
+		{
+			redis_command_writer _writer;
+			_writer.command(_cmd, argv);
+			redis_metrics::scope _metrics(_cmd);
+			reply = execute(_context, _writer.data(), _writer.size());
+			_metrics.done(_writer.size(), reply);
 		}
-		reply = (redisReply*)redisCommandArgv(_context, _argv.size(), _argv.data(), _argvlen.data());
-		ref_reply.reset(reply, free_reply);
-		cmd = _sout.str();
+		ref_reply = make_ref(_context, reply);
+		cmd = redis_command_capture::need_render(is_failed()) ?
+			redis_command_render(_cmd, argv) : _cmd;
 	}
 
 	redisReply** operator &() { return &reply; }
@@ -313,6 +963,130 @@ public:
 		return (reply->type == REDIS_REPLY_STATUS && _stricmp(reply->str, "QUEUED") == 0);
 	}
 
+	//WITHSCORESĻӦ(RESP2ƽ̻RESP3Ƕ)˳׷ӵ_out,ֻһ
+	void append_scored(std::vector<redis_scored_member>& _out)const
+	{
+		check_error();
+		redis_test(reply->type == REDIS_REPLY_ARRAY, redis_error_code::reply_type_incorrect, cmd);
+
+		bool _nested = reply->elements > 0 && reply->element[0]->type == REDIS_REPLY_ARRAY;
+		redis_test(_nested || reply->elements % 2 == 0, redis_error_code::reply_data_incorrect, cmd);
+
+		size_t _count = _nested ? reply->elements : reply->elements / 2;
+		_out.reserve(_out.size() + _count);
+		for (size_t i = 0; i < _count; i++) {
+			const redisReply* _member = nullptr;
+			const redisReply* _score = nullptr;
+			if (_nested) {
+				redis_test(reply->element[i]->type == REDIS_REPLY_ARRAY && reply->element[i]->elements == 2,
+					redis_error_code::reply_data_incorrect, cmd);
+				_member = reply->element[i]->element[0];
+				_score = reply->element[i]->element[1];
+			}
+			else {
+				_member = reply->element[i * 2];
+				_score = reply->element[i * 2 + 1];
+			}
+			redis_test(_member->type == REDIS_REPLY_STRING, redis_error_code::reply_type_incorrect, cmd);
+
+			redis_scored_member _item = { std::string(_member->str, _member->len), 0 };
+			if (_score->type == REDIS_REPLY_DOUBLE) {
+				_item.score = _score->dval;
+			}
+			else {
+				redis_test(_score->type == REDIS_REPLY_STRING
+					&& redis_parse_double(_score->str, _score->len, _item.score),
+					redis_error_code::reply_data_incorrect, cmd);
+			}
+			_out.push_back(std::move(_item));
+		}
+	}
+
+	//ַ鰴˳׷ӵ_out
+	void append_strings(std::vector<std::string>& _out)const
+	{
+		check_error();
+		redis_test(reply->type == REDIS_REPLY_ARRAY, redis_error_code::reply_type_incorrect, cmd);
+
+		_out.reserve(_out.size() + reply->elements);
+		for (size_t i = 0; i < reply->elements; i++) {
+			const redisReply* _element = reply->element[i];
+			redis_test(_element->type == REDIS_REPLY_STRING, redis_error_code::reply_type_incorrect, cmd);
+			_out.push_back(std::string(_element->str, _element->len));
+		}
+	}
+
+	//ֶ/ֵɶԵĻӦ(HGETALL,RESP2ƽRESP3 map)Իص_f(ֶ, ֶγ, ֵ, ֵ)
+	//ֱӴݻӦеĻ,
+	template<typename F>
+	void for_each_pair(F _f)const
+	{
+		check_error();
+		bool _map = reply->type == REDIS_REPLY_ARRAY;
+#ifdef REDIS_REPLY_MAP
+		_map = _map || reply->type == REDIS_REPLY_MAP;
+#endif
+		redis_test(_map, redis_error_code::reply_type_incorrect, cmd);
+		redis_test(reply->elements % 2 == 0, redis_error_code::reply_data_incorrect, cmd);
+
+		for (size_t i = 0; i < reply->elements; i += 2) {
+			const redisReply* _field = reply->element[i];
+			const redisReply* _value = reply->element[i + 1];
+			redis_test(_field->type == REDIS_REPLY_STRING && _value->type == REDIS_REPLY_STRING,
+				redis_error_code::reply_type_incorrect, cmd);
+			_f(_field->str, _field->len, _value->str, _value->len);
+		}
+	}
+
+	//ַ(HMGET)ص_f(±, ֵ, ֵ),nilԪ
+	template<typename F>
+	void for_each_string(F _f)const
+	{
+		check_error();
+		redis_test(reply->type == REDIS_REPLY_ARRAY, redis_error_code::reply_type_incorrect, cmd);
+
+		for (size_t i = 0; i < reply->elements; i++) {
+			const redisReply* _element = reply->element[i];
+			if (_element->type == REDIS_REPLY_NIL) {
+				continue;
+			}
+			redis_test(_element->type == REDIS_REPLY_STRING, redis_error_code::reply_type_incorrect, cmd);
+			_f(i, _element->str, _element->len);
+		}
+	}
+
+	//Ŀ(XRANGE,XREADGROUPеһ)˳׷ӵ_out
+	void append_stream_entries(std::vector<redis_stream_entry>& _out)const
+	{
+		check_error();
+		append_stream_entries(reply, _out);
+	}
+
+	//XREAD/XREADGROUPĻӦ(RESP2RESP3 map)׷ӵ_out,ʱnilӦ׷
+	void append_streams(std::vector<redis_stream_result>& _out)const
+	{
+		check_error();
+		if (reply->type == REDIS_REPLY_NIL) {
+			return;
+		}
+#ifdef REDIS_REPLY_MAP
+		if (reply->type == REDIS_REPLY_MAP) {
+			redis_test(reply->elements % 2 == 0, redis_error_code::reply_data_incorrect, cmd);
+			for (size_t i = 0; i < reply->elements; i += 2) {
+				append_stream(reply->element[i], reply->element[i + 1], _out);
+			}
+			return;
+		}
+#endif
+		redis_test(reply->type == REDIS_REPLY_ARRAY, redis_error_code::reply_type_incorrect, cmd);
+		for (size_t i = 0; i < reply->elements; i++) {
+			const redisReply* _stream = reply->element[i];
+			redis_test(_stream->type == REDIS_REPLY_ARRAY && _stream->elements == 2,
+				redis_error_code::reply_type_incorrect, cmd);
+			append_stream(_stream->element[0], _stream->element[1], _out);
+		}
+	}
+
 	operator redisReply*()const { return reply; }
 	explicit operator int64_t()const
 	{
@@ -333,11 +1107,29 @@ public:
 		if (reply->type == REDIS_REPLY_INTEGER) {
 			return redis_value(reply->integer);
 		}
-		if (reply->type == REDIS_REPLY_STRING) {
-			return redis_value(reply->str);
+		bool _text = reply->type == REDIS_REPLY_STRING;
+#ifdef REDIS_REPLY_DOUBLE
+		_text = _text || reply->type == REDIS_REPLY_DOUBLE;
+#endif
+		redis_test(_text, redis_error_code::reply_type_incorrect, cmd);
+		return redis_value(reply->str, reply->len);
+	}
+	//ֱַӴӻӦĻ,redis_value
+	explicit operator double()const
+	{
+		check_error();
+		if (reply->type == REDIS_REPLY_INTEGER) {
+			return (double)reply->integer;
+		}
+#ifdef REDIS_REPLY_DOUBLE
+		if (reply->type == REDIS_REPLY_DOUBLE) {
+			return reply->dval;
 		}
-		redis_test(false, redis_error_code::reply_type_incorrect, cmd);
-		return redis_value();
+#endif
+		redis_test(reply->type == REDIS_REPLY_STRING, redis_error_code::reply_type_incorrect, cmd);
+		double _v = 0;
+		redis_test(redis_parse_double(reply->str, reply->len, _v), redis_error_code::reply_data_incorrect, cmd);
+		return _v;
 	}
 
 	template<typename T>
@@ -383,14 +1175,8 @@ public:
 		redis_test(reply->elements == 2, redis_error_code::reply_data_incorrect, cmd);
 
 		std::pair<F, V> _pair;
-		{
-			redis_reply _redis_reply(reply->element[0], ref_reply);
-			_pair.first = (F)std::move(_redis_reply);
-		}
-		{
-			redis_reply _redis_reply(reply->element[1], ref_reply);
-			_pair.second = (V)std::move(_redis_reply);
-		}
+		_pair.first = convert_element<F>(0);
+		_pair.second = convert_element<V>(1);
 
 		return _pair;
 	}
@@ -401,7 +1187,7 @@ inline redis_reply redis_get_reply(redisContext* _context, const std::string& _c
 {
 	redisReply* _reply = nullptr;
 	int ret = redisGetReply(_context, (void**)&_reply);
-	redis_reply _reply2(_reply, _cmd);
+	redis_reply _reply2(_context, _reply, _cmd);
 	redis_test(ret == REDIS_OK, redis_error_code::command_error, _cmd);
 	return std::move(_reply2);
 }
@@ -0,0 +1,232 @@
+#pragma once
+
+#ifndef __REDIS_SCAN_H__
+#define __REDIS_SCAN_H__
+
+#ifdef TC_REDIS
+namespace TC_REDIS {
+#endif
+
+//ɨԴ,һѾĿڵ(SELECTĿdb),ɨɨͷ
+typedef std::function<redisContext*()> redis_scan_source;
+
+//SCAN
+//ÿɨԴ(Ⱥڵ,ͬһʵĲͬdb)Լ̺߳϶ƽα
+//ɨ赽keyн,ɵSCAN߳λص,صʱɨ̻߳ȴ
+//صfalseʱɨ̶ֹ߳ͣ
+class redis_parallel_scan
+{
+protected:
+	std::vector<redis_scan_source> sources;
+	size_t threads;
+	size_t queue_size;
+
+	struct shared_state {
+		std::mutex mutex;
+		std::condition_variable not_full;
+		std::condition_variable not_empty;
+		std::deque<std::vector<std::string>> batches;
+		size_t running;
+		bool stopped;
+		std::exception_ptr error;
+	};
+
+	//һkey,ʱȴ,Ѿֹͣfalse
+	bool push(shared_state& _state, std::vector<std::string>& _batch)
+	{
+		std::unique_lock<std::mutex> _lock(_state.mutex);
+		_state.not_full.wait(_lock, [&]() { return _state.stopped || _state.batches.size() < queue_size; });
+		if (_state.stopped) {
+			return false;
+		}
+		_state.batches.push_back(std::move(_batch));
+		_batch.clear();
+		_state.not_empty.notify_one();
+		return true;
+	}
+
+	void worker(shared_state& _state, std::atomic<size_t>& _next, const std::string& _match, int _count,
+		const redis_scan_dedup& _dedup)
+	{
+		try
+		{
+			for (size_t i = _next++; i < sources.size(); i = _next++)
+			{
+				std::unique_ptr<redisContext, void(*)(redisContext*)> _context(sources[i](), redisFree);
+				redis_test(_context != nullptr, redis_error_code::command_error, "CONNECT");
+				redis_test(!_context->err, redis_error_code::command_error, "CONNECT");
+
+				bool _running = true;
+				std::vector<std::string> _batch;
+				redis_context(_context.get()).key().SCAN(_match, _count, [&](const std::string& _key) {
+					_batch.push_back(_key);
+					if (_batch.size() >= (size_t)_count) {
+						_running = push(_state, _batch);
+					}
+					return _running;
+				}, _dedup);
+				if (!_running || (!_batch.empty() && !push(_state, _batch))) {
+					break;
+				}
+			}
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> _lock(_state.mutex);
+			if (!_state.error) {
+				_state.error = std::current_exception();
+			}
+			_state.stopped = true;
+			_state.not_full.notify_all();
+		}
+
+		std::lock_guard<std::mutex> _lock(_state.mutex);
+		_state.running--;
+		_state.not_empty.notify_one();
+	}
+public:
+	//_threadsΪ0ʱÿɨԴһ߳
+	//_queue_sizeΪ໺,ÿcountkey
+	redis_parallel_scan(const std::vector<redis_scan_source>& _sources, size_t _threads = 0, size_t _queue_size = 16) :
+		sources(_sources), threads(_threads), queue_size(_queue_size)
+	{
+		redis_test(_queue_size > 0);
+	}
+
+	//ɨĽڵ
+	static std::vector<redis_scan_source> nodes(const std::vector<std::pair<std::string, int>>& _nodes,
+		std::chrono::milliseconds _timeout = std::chrono::milliseconds(1000))
+	{
+		std::vector<redis_scan_source> _sources;
+		for (auto& _node : _nodes) {
+			_sources.push_back(redis_connector(_node.first, _node.second, _timeout));
+		}
+		return _sources;
+	}
+
+	//ɨͬһʵĶdb
+	static std::vector<redis_scan_source> databases(const std::string& _host, int _port, const std::vector<int>& _dbs,
+		std::chrono::milliseconds _timeout = std::chrono::milliseconds(1000))
+	{
+		std::vector<redis_scan_source> _sources;
+		for (auto _db : _dbs) {
+			_sources.push_back([_host, _port, _db, _timeout]() {
+				//SELECTʧʱͷ,ϷصĴ
+				std::unique_ptr<redisContext, void(*)(redisContext*)> _context(redis_connect(_host, _port, _timeout), redisFree);
+				if (_context != nullptr && !_context->err) {
+					redis_reply _reply(_context.get(), "SELECT", _db);
+					const redisReply* _select = _reply;
+					if (_select == nullptr) {
+						throw redis_error(redis_error_code::reply_is_null, _context->errstr, "SELECT");
+					}
+					if (_select->type == REDIS_REPLY_ERROR) {
+						throw redis_error(redis_error_code::reply_is_error, std::string(_select->str, _select->len), "SELECT");
+					}
+					redis_test(_select->type == REDIS_REPLY_STATUS, redis_error_code::reply_type_incorrect, "SELECT");
+				}
+				return _context.release();
+			});
+		}
+		return _sources;
+	}
+
+	//redis_key::SCANͬĲͻصԼ,صڵִ߳
+	//ÿɨԴʹһdedupĸ,κһɨԴʱֹͣɨ貢׳ô
+	void SCAN(const std::string& match = "*", int count = 10,
+		std::function<bool(const std::string&)> cb = [](const std::string& /*key*/) { return true; },
+		const redis_scan_dedup& dedup = redis_scan_dedup())
+	{
+		redis_test(count > 0);
+		if (sources.empty()) {
+			return;
+		}
+
+		shared_state _state;
+		_state.running = std::min(threads == 0 ? sources.size() : threads, sources.size());
+		_state.stopped = false;
+
+		std::atomic<size_t> _next(0);
+		std::vector<std::thread> _threads;
+		_threads.reserve(_state.running);
+		try {
+			for (size_t i = 0, n = _state.running; i < n; i++) {
+				_threads.emplace_back([&]() { worker(_state, _next, match, count, dedup); });
+			}
+		}
+		catch (...) {
+			//Ѿ̱߳ͣ²join,std::threadʱterminate
+			{
+				std::lock_guard<std::mutex> _lock(_state.mutex);
+				_state.stopped = true;
+				_state.not_full.notify_all();
+			}
+			for (auto& _thread : _threads) {
+				_thread.join();
+			}
+			throw;
+		}
+
+		try
+		{
+			std::vector<std::string> _batch;
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> _lock(_state.mutex);
+					_state.not_empty.wait(_lock, [&]() { return !_state.batches.empty() || _state.running == 0; });
+					if (_state.batches.empty() || _state.stopped) {
+						break;
+					}
+					_batch = std::move(_state.batches.front());
+					_state.batches.pop_front();
+					_state.not_full.notify_one();
+				}
+
+				for (auto& _key : _batch) {
+					if (!cb(_key)) {
+						std::lock_guard<std::mutex> _lock(_state.mutex);
+						_state.stopped = true;
+						_state.not_full.notify_all();
+						break;
+					}
+				}
+			}
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> _lock(_state.mutex);
+			_state.stopped = true;
+			_state.not_full.notify_all();
+			if (!_state.error) {
+				_state.error = std::current_exception();
+			}
+		}
+
+		for (auto& _thread : _threads) {
+			_thread.join();
+		}
+		if (_state.error) {
+			std::rethrow_exception(_state.error);
+		}
+	}
+};
+
+/*
+	һ򵥵
+
+	//Ⱥÿڵһ߳
+	redis_parallel_scan _scan(_cluster.scan_sources());
+	_scan.SCAN("user:*", 1000, [](const std::string& _key) {
+		...
+		return true;
+	});
+
+	//ͬһʵĶdb
+	redis_parallel_scan _scan2(redis_parallel_scan::databases("127.0.0.1", 6379, { 0, 1, 2, 3 }));
+*/
+
+#ifdef TC_REDIS
+}
+#endif
+
+#endif
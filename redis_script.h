@@ -0,0 +1,126 @@
+#pragma once
+
+#ifndef __REDIS_SCRIPT_H__
+#define __REDIS_SCRIPT_H__
+
+#ifdef TC_REDIS
+namespace TC_REDIS {
+#endif
+
+//Luaű
+//һִʱSCRIPT LOADõSHA1,֮EVALSHAִ,ֻSHA1ű
+//SHA1ֻɽűݾ,ӹ;NOSCRIPT(,SCRIPT FLUSH,Ⱥڵ)ʱڸ¼زһ
+//--дڽűԭִ,redis_watchWATCH/MULTI/EXECͻ
+class redis_script
+{
+protected:
+	std::string source;
+	mutable std::mutex mutex;
+	std::string sha;
+
+	static bool is_noscript(const redisReply* _reply) {
+		return _reply != nullptr && _reply->type == REDIS_REPLY_ERROR
+			&& _reply->len >= 8 && memcmp(_reply->str, "NOSCRIPT", 8) == 0;
+	}
+
+	template<typename T>
+	static T convert(redis_reply& _reply, T*) {
+		return redis_convert<T>()(_reply);
+	}
+	static redis_reply convert(redis_reply& _reply, redis_reply*) {
+		return std::move(_reply);
+	}
+
+	std::string get_or_load(redisContext* _context)
+	{
+		std::string _sha = get_sha();
+		return _sha.empty() ? load(_context) : _sha;
+	}
+
+	redis_script(const redis_script&) = delete;
+	redis_script& operator =(const redis_script&) = delete;
+public:
+	explicit redis_script(const std::string& _source) :source(_source) {
+	}
+
+	const std::string& get_source()const { return source; }
+
+	//δʱؿմ
+	std::string get_sha()const
+	{
+		std::lock_guard<std::mutex> _lock(mutex);
+		return sha;
+	}
+
+	//SCRIPT LOAD,SHA1
+	std::string load(redisContext* _context)
+	{
+		std::string _sha = (std::string)redis_reply(_context, "SCRIPT", "LOAD", source);
+		std::lock_guard<std::mutex> _lock(mutex);
+		sha = _sha;
+		return _sha;
+	}
+
+	//ִнű,_keys_argsֱӦűеKEYSARGV
+	//TΪӦת,ͬʹredis_convert<T>,ĬϷredis_reply
+	template<typename T = redis_reply, typename... ARGS>
+	T execute(redisContext* _context, const std::vector<std::string>& _keys, ARGS&&... _args)
+	{
+		redis_reply _reply(_context, "EVALSHA", get_or_load(_context), _keys.size(), redis_args(_keys), _args...);
+		if (is_noscript(_reply)) {
+			_reply = redis_reply(_context, "EVALSHA", load(_context), _keys.size(), redis_args(_keys), _args...);
+		}
+		return convert(_reply, (T*)nullptr);
+	}
+
+	//ڼȺִнű,һkey·,keyͬһslot
+	//ڵֱ𻺴ű,NOSCRIPTʱڵһkeyڵĽڵϼ;ûkeyʱEVALִ
+	template<typename T = redis_reply, typename... ARGS>
+	T execute(redis_cluster_context& _cluster, const std::vector<std::string>& _keys, ARGS&&... _args)
+	{
+		std::string _sha = get_sha();
+		if (_keys.empty()) {
+			if (!_sha.empty()) {
+				redis_reply _reply = _cluster.execute("EVALSHA", _sha, 0, _args...);
+				if (!is_noscript(_reply)) {
+					return convert(_reply, (T*)nullptr);
+				}
+			}
+			redis_reply _reply = _cluster.execute("EVAL", source, 0, _args...);
+			return convert(_reply, (T*)nullptr);
+		}
+
+		if (_sha.empty()) {
+			_sha = load(_cluster.get_context(_keys.front()));
+		}
+		redis_reply _reply = _cluster.execute("EVALSHA", _sha, _keys.size(), redis_args(_keys), _args...);
+		if (is_noscript(_reply)) {
+			_sha = load(_cluster.get_context(_keys.front()));
+			_reply = _cluster.execute("EVALSHA", _sha, _keys.size(), redis_args(_keys), _args...);
+		}
+		return convert(_reply, (T*)nullptr);
+	}
+};
+
+/*
+	һ򵥵
+
+	//ʱһ,ؼӺֵ,-1
+	static redis_script _incr_capped(
+		"local v = tonumber(redis.call('GET', KEYS[1]) or '0') "
+		"if v >= tonumber(ARGV[1]) then return -1 end "
+		"return redis.call('INCR', KEYS[1])");
+
+	int64_t _value = _incr_capped.execute<int64_t>(_context, { "counter" }, 100);
+
+	//Ƚϲ
+	static redis_script _cas(
+		"if redis.call('GET', KEYS[1]) == ARGV[1] then redis.call('SET', KEYS[1], ARGV[2]) return 1 end return 0");
+	bool _swapped = _cas.execute<int64_t>(_cluster, { "lock:1" }, "old", "new") == 1;
+*/
+
+#ifdef TC_REDIS
+}
+#endif
+
+#endif
@@ -0,0 +1,196 @@
+#pragma once
+
+#ifndef __REDIS_STREAM_H__
+#define __REDIS_STREAM_H__
+
+#ifdef TC_REDIS
+namespace TC_REDIS {
+#endif
+
+//ѭͳ,ʱ䵥λΪ΢
+struct redis_stream_consumer_stats {
+	uint64_t batches;		//
+	uint64_t entries;		//Ŀ
+	uint64_t acked;			//ȷϵĿ
+	uint64_t empty_polls;	//BLOCKʱûжĿĴ
+	uint64_t fetch_us;		//ȡ(ͬһXACK)ۼʱ
+	uint64_t handle_us;		//صۼƴʱ
+	uint64_t last_fetch_us;
+	uint64_t last_handle_us;
+	uint64_t max_fetch_us;
+	uint64_t max_handle_us;
+};
+
+//ѭ
+//ÿһ: һXACKһXREADGROUP COUNT n BLOCK msͬһܵз
+//ʱȶߴȷϵĿ(ϴ˳ʱδȷϵ),ٶĿ
+//ص׳쳣ʱǰȷ,ڴȷб,쳣run()׳
+//רڱѭ,ʱҪblock
+class redis_stream_consumer
+{
+public:
+	//һĿ,falseʱȷϱ˳ѭ
+	typedef std::function<bool(std::vector<redis_stream_entry>&)> handler_type;
+protected:
+	redisContext* context;
+	std::string key;
+	std::string group;
+	std::string consumer;
+	int64_t count;
+	int64_t block;
+	std::atomic<bool> stopping;
+
+	std::atomic<uint64_t> batches;
+	std::atomic<uint64_t> entries;
+	std::atomic<uint64_t> acked;
+	std::atomic<uint64_t> empty_polls;
+	std::atomic<uint64_t> fetch_us;
+	std::atomic<uint64_t> handle_us;
+	std::atomic<uint64_t> last_fetch_us;
+	std::atomic<uint64_t> last_handle_us;
+	std::atomic<uint64_t> max_fetch_us;
+	std::atomic<uint64_t> max_handle_us;
+
+	static uint64_t elapsed_us(std::chrono::steady_clock::time_point _start) {
+		return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start).count();
+	}
+
+	static void record(uint64_t _us, std::atomic<uint64_t>& _total, std::atomic<uint64_t>& _last, std::atomic<uint64_t>& _max)
+	{
+		_total += _us;
+		_last = _us;
+		if (_us > _max.load()) {
+			_max = _us;
+		}
+	}
+
+	redis_stream_consumer(const redis_stream_consumer&) = delete;
+	redis_stream_consumer& operator =(const redis_stream_consumer&) = delete;
+public:
+	redis_stream_consumer(redisContext* _context, const std::string& _key, const std::string& _group, const std::string& _consumer,
+		int64_t _count = 100, std::chrono::milliseconds _block = std::chrono::milliseconds(1000)) :
+		context(_context), key(_key), group(_group), consumer(_consumer), count(_count), block((int64_t)_block.count()),
+		stopping(false), batches(0), entries(0), acked(0), empty_polls(0), fetch_us(0), handle_us(0),
+		last_fetch_us(0), last_handle_us(0), max_fetch_us(0), max_handle_us(0)
+	{
+		redis_test(_count > 0 && _block.count() >= 0);
+	}
+
+	//(),Ѵʱ
+	void create_group(const std::string& _id = "$")
+	{
+		try {
+			redis_context(context).stream().XGROUP_CREATE(key, group, _id, true);
+		}
+		catch (const redis_error& e) {
+			if (e.describe.compare(0, 9, "BUSYGROUP") != 0) {
+				throw;
+			}
+		}
+	}
+
+	//ѭ,ֱصfalsestop()
+	//stop()block֮Ч
+	void run(handler_type _handler)
+	{
+		std::vector<redis_stream_id> _acks;
+		std::vector<redis_stream_entry> _entries;
+		std::string _id = "0";
+		bool _running = true;
+
+		while (true)
+		{
+			auto _start = std::chrono::steady_clock::now();
+			redis_pipeline _pipeline(context);
+			redis_future<int64_t> _ack;
+			if (!_acks.empty()) {
+				_ack = _pipeline.stream().XACK(key, group, _acks);
+			}
+			if (!_running || stopping.load()) {
+				_pipeline.flush();
+				acked += _ack.valid() ? (uint64_t)_ack.get() : 0;
+				break;
+			}
+			auto _read = _pipeline.stream().XREADGROUP(group, consumer, { key }, { _id }, count, _id == ">" ? block : -1);
+			_pipeline.flush();
+			acked += _ack.valid() ? (uint64_t)_ack.get() : 0;
+			_acks.clear();
+
+			_entries.clear();
+			for (auto& _stream : _read.get()) {
+				if (_entries.empty()) {
+					_entries.swap(_stream.second);
+				}
+				else {
+					std::move(_stream.second.begin(), _stream.second.end(), std::back_inserter(_entries));
+				}
+			}
+			record(elapsed_us(_start), fetch_us, last_fetch_us, max_fetch_us);
+
+			if (_entries.empty()) {
+				if (_id == ">") {
+					empty_polls++;
+				}
+				_id = ">";
+				continue;
+			}
+			if (_id != ">") {
+				//ȷϵĿID
+				_id = _entries.back().id.to_string();
+			}
+
+			_start = std::chrono::steady_clock::now();
+			_running = _handler(_entries);
+			record(elapsed_us(_start), handle_us, last_handle_us, max_handle_us);
+			batches++;
+			entries += _entries.size();
+
+			_acks.reserve(_entries.size());
+			for (auto& _entry : _entries) {
+				_acks.push_back(_entry.id);
+			}
+		}
+	}
+
+	//̵߳
+	void stop() {
+		stopping = true;
+	}
+
+	redis_stream_consumer_stats stats()const
+	{
+		redis_stream_consumer_stats _stats;
+		_stats.batches = batches.load();
+		_stats.entries = entries.load();
+		_stats.acked = acked.load();
+		_stats.empty_polls = empty_polls.load();
+		_stats.fetch_us = fetch_us.load();
+		_stats.handle_us = handle_us.load();
+		_stats.last_fetch_us = last_fetch_us.load();
+		_stats.last_handle_us = last_handle_us.load();
+		_stats.max_fetch_us = max_fetch_us.load();
+		_stats.max_handle_us = max_handle_us.load();
+		return _stats;
+	}
+};
+
+/*
+	һ򵥵
+
+	_context.stream().XADD("orders", { { "id", "1001" }, { "amount", "30" } });
+
+	redis_stream_consumer _consumer(_context2, "orders", "billing", "worker-1", 500);
+	_consumer.create_group("0");
+	_consumer.run([](std::vector<redis_stream_entry>& _entries) {
+		for (auto& _entry : _entries) {
+			//_entry.id, _entry.fields
+		}
+		return true;
+	});
+*/
+
+#ifdef TC_REDIS
+}
+#endif
+
+#endif
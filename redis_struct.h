@@ -0,0 +1,258 @@
+#pragma once
+
+#ifndef __REDIS_STRUCT_H__
+#define __REDIS_STRUCT_H__
+
+#ifdef TC_REDIS
+namespace TC_REDIS {
+#endif
+
+//ṹһhashֶ,nameΪhashеֶ,memberΪӦĳԱ
+template<typename C, typename M>
+struct redis_field_desc {
+	const char* name;
+	size_t len;
+	M C::* member;
+};
+
+template<typename C, typename M, size_t N>
+constexpr redis_field_desc<C, M> redis_field(const char(&_name)[N], M C::* _member)
+{
+	return redis_field_desc<C, M>{ _name, N - 1, _member };
+}
+
+//ṹֶα,ĬʹT::redis_fields()
+//޷޸ĵĽṹػģ,ṩ̬fields()
+template<typename T>
+struct redis_struct_traits {
+	template<typename U = T>
+	static constexpr auto fields() -> decltype(U::redis_fields()) { return U::redis_fields(); }
+};
+
+//жǷֶα
+template<typename T, typename = void>
+class is_redis_struct {
+public:
+	enum { value = false };
+};
+
+template<typename T>
+class is_redis_struct<T, decltype((void)redis_struct_traits<T>::fields())> {
+public:
+	enum { value = true };
+};
+
+//ֵֶĽ,ʧ׳reply_data_incorrect
+inline void redis_struct_assign(std::string& _m, const char* _str, size_t _len, const std::string& /*_cmd*/)
+{
+	_m.assign(_str, _len);
+}
+
+inline void redis_struct_assign(bool& _m, const char* _str, size_t _len, const std::string& _cmd)
+{
+	int64_t _v = 0;
+	redis_test(redis_parse_int(_str, _len, _v), redis_error_code::reply_data_incorrect, _cmd);
+	_m = _v != 0;
+}
+
+template<typename M>
+typename std::enable_if<std::is_integral<M>::value>::type
+	redis_struct_assign(M& _m, const char* _str, size_t _len, const std::string& _cmd)
+{
+	int64_t _v = 0;
+	redis_test(redis_parse_int(_str, _len, _v), redis_error_code::reply_data_incorrect, _cmd);
+	redis_test((int64_t)(M)_v == _v && (std::is_signed<M>::value || _v >= 0),
+		redis_error_code::reply_data_incorrect, _cmd);
+	_m = (M)_v;
+}
+
+template<typename M>
+typename std::enable_if<std::is_floating_point<M>::value>::type
+	redis_struct_assign(M& _m, const char* _str, size_t _len, const std::string& _cmd)
+{
+	double _v = 0;
+	redis_test(redis_parse_double(_str, _len, _v), redis_error_code::reply_data_incorrect, _cmd);
+	_m = (M)_v;
+}
+
+template<typename M>
+typename std::enable_if<std::is_enum<M>::value>::type
+	redis_struct_assign(M& _m, const char* _str, size_t _len, const std::string& _cmd)
+{
+	typename std::underlying_type<M>::type _v;
+	redis_struct_assign(_v, _str, _len, _cmd);
+	_m = (M)_v;
+}
+
+//ṹhashֶ֮ı
+//ֶɢб,ÿֶһ,ʱֻһλӦ,мstd::map
+//ֱֵֶӴӻӦĻ,ʱַ
+template<typename T>
+class redis_struct
+{
+public:
+	typedef decltype(redis_struct_traits<T>::fields()) fields_type;
+	enum { field_count = std::tuple_size<fields_type>::value };
+	static_assert(field_count > 0, "redis_fields() must declare at least one field");
+
+	static const fields_type& fields()
+	{
+		static const fields_type _fields = redis_struct_traits<T>::fields();
+		return _fields;
+	}
+protected:
+	typedef void(*assign_type)(T&, const char*, size_t, const std::string&);
+
+	//ɢбĲλ,Сֶ2
+	static constexpr size_t slots(size_t n, size_t _s = 8) { return _s >= n * 2 ? _s : slots(n, _s * 2); }
+	enum { slot_count = slots(field_count) };
+
+	struct table_type {
+		const char* names[field_count];
+		size_t lens[field_count];
+		assign_type assigns[field_count];
+		uint16_t slots[slot_count];	//ֶ±+1,0Ϊ
+	};
+
+	static size_t hash(const char* _str, size_t _len)
+	{
+		uint32_t _h = 2166136261u;
+		for (size_t i = 0; i < _len; i++) {
+			_h = (_h ^ (uint8_t)_str[i]) * 16777619u;
+		}
+		return _h;
+	}
+
+	template<size_t I>
+	static void assign(T& _v, const char* _str, size_t _len, const std::string& _cmd)
+	{
+		redis_struct_assign(_v.*(std::get<I>(fields()).member), _str, _len, _cmd);
+	}
+
+	template<size_t... I>
+	static table_type make_table(std::index_sequence<I...>)
+	{
+		table_type _table = { { std::get<I>(fields()).name... }, { std::get<I>(fields()).len... }, { &assign<I>... }, {} };
+		for (size_t i = 0; i < field_count; i++) {
+			size_t _slot = hash(_table.names[i], _table.lens[i]) & (slot_count - 1);
+			for (; _table.slots[_slot] != 0; _slot = (_slot + 1) & (slot_count - 1)) {
+				size_t j = _table.slots[_slot] - 1;
+				redis_test(_table.lens[i] != _table.lens[j] || memcmp(_table.names[i], _table.names[j], _table.lens[i]) != 0,
+					redis_error_code::command_error, _table.names[i]);
+			}
+			_table.slots[_slot] = (uint16_t)(i + 1);
+		}
+		return _table;
+	}
+
+	static const table_type& table()
+	{
+		static const table_type _table = make_table(std::make_index_sequence<field_count>());
+		return _table;
+	}
+
+	template<typename F, typename TUPLE, size_t... I>
+	static auto invoke(F& _f, TUPLE&& _args, std::index_sequence<I...>) -> decltype(_f(std::get<I>(_args)...))
+	{
+		return _f(std::get<I>(_args)...);
+	}
+
+	template<typename F, size_t... I>
+	static auto apply_pairs(const T& _v, F& _f, std::index_sequence<I...>)
+		-> decltype(invoke(_f, std::tuple_cat(std::forward_as_tuple(std::get<I>(fields()).name, _v.*(std::get<I>(fields()).member))...),
+			std::make_index_sequence<field_count * 2>()))
+	{
+		return invoke(_f, std::tuple_cat(std::forward_as_tuple(std::get<I>(fields()).name, _v.*(std::get<I>(fields()).member))...),
+			std::make_index_sequence<field_count * 2>());
+	}
+
+	template<typename F, size_t... I>
+	static auto apply_names(F& _f, std::index_sequence<I...>) -> decltype(_f(std::get<I>(fields()).name...))
+	{
+		return _f(std::get<I>(fields()).name...);
+	}
+public:
+	//ֶֶ±,ڷ-1
+	static int find(const char* _name, size_t _len)
+	{
+		const table_type& _table = table();
+		for (size_t _slot = hash(_name, _len) & (slot_count - 1); _table.slots[_slot] != 0; _slot = (_slot + 1) & (slot_count - 1)) {
+			size_t i = _table.slots[_slot] - 1;
+			if (_table.lens[i] == _len && memcmp(_table.names[i], _name, _len) == 0) {
+				return (int)i;
+			}
+		}
+		return -1;
+	}
+
+	//HGETALLĻӦ,δֶκ,ؽֶ
+	static size_t decode(const redis_reply& _reply, T& _v)
+	{
+		const table_type& _table = table();
+		size_t _count = 0;
+		_reply.for_each_pair([&](const char* _field, size_t _field_len, const char* _str, size_t _len) {
+			int i = find(_field, _field_len);
+			if (i >= 0) {
+				_table.assigns[i](_v, _str, _len, _reply.get_cmd());
+				_count++;
+			}
+		});
+		return _count;
+	}
+
+	//밴ֶα˳HMGETӦ,ڵֶαԭֵ,ؽֶ
+	static size_t decode_values(const redis_reply& _reply, T& _v)
+	{
+		const table_type& _table = table();
+		size_t _count = 0;
+		_reply.for_each_string([&](size_t i, const char* _str, size_t _len) {
+			redis_test(i < field_count, redis_error_code::reply_data_incorrect, _reply.get_cmd());
+			_table.assigns[i](_v, _str, _len, _reply.get_cmd());
+			_count++;
+		});
+		return _count;
+	}
+
+	//(ֶ, ֵ, ֶ, ֵ...)_f,ֱֵýṹԱ
+	template<typename F>
+	static auto apply_pairs(const T& _v, F _f)
+		-> decltype(apply_pairs(_v, _f, std::make_index_sequence<field_count>()))
+	{
+		return apply_pairs(_v, _f, std::make_index_sequence<field_count>());
+	}
+
+	//(ֶ, ֶ...)_f
+	template<typename F>
+	static auto apply_names(F _f) -> decltype(apply_names(_f, std::make_index_sequence<field_count>()))
+	{
+		return apply_names(_f, std::make_index_sequence<field_count>());
+	}
+};
+
+/*
+	һ򵥵
+
+	struct user_profile {
+		std::string name;
+		int64_t age;
+		double score;
+		bool vip;
+
+		static constexpr auto redis_fields() {
+			return std::make_tuple(
+				redis_field("name", &user_profile::name),
+				redis_field("age", &user_profile::age),
+				redis_field("score", &user_profile::score),
+				redis_field("vip", &user_profile::vip));
+		}
+	};
+
+	_redis.hash().HMSET("user:1", _profile);
+	user_profile _profile2 = _redis.hash().HGETALL<user_profile>("user:1");
+*/
+
+#ifdef TC_REDIS
+}
+#endif
+
+#endif
@@ -0,0 +1,415 @@
+#pragma once
+
+#ifndef __REDIS_SUBSCRIBER_H__
+#define __REDIS_SUBSCRIBER_H__
+
+#ifdef TC_REDIS
+namespace TC_REDIS {
+#endif
+
+//յһϢ,patternֻPSUBSCRIBEϢֵ
+struct redis_message {
+	std::string pattern;
+	std::string channel;
+	std::string payload;
+};
+
+//ߵߵн绷ζ
+//ֱдλ,λԪ,Ԫصڴڶ֮ѭʹ
+template<typename T>
+class redis_spsc_queue
+{
+protected:
+	std::unique_ptr<T[]> items;
+	size_t mask;
+	std::atomic<size_t> head;		//ߵλ
+	char pad[64];					//headtailͬһ
+	std::atomic<size_t> tail;		//ߵλ
+
+	static size_t round_up(size_t n) {
+		size_t _size = 2;
+		while (_size < n) {
+			_size *= 2;
+		}
+		return _size;
+	}
+
+	redis_spsc_queue(const redis_spsc_queue&) = delete;
+	redis_spsc_queue& operator =(const redis_spsc_queue&) = delete;
+public:
+	explicit redis_spsc_queue(size_t _capacity) :
+		items(new T[round_up(_capacity)]), mask(round_up(_capacity) - 1), head(0), tail(0)
+	{
+	}
+
+	size_t capacity()const { return mask + 1; }
+
+	//_fill(T&)дһλ,false
+	template<typename F>
+	bool try_push(F _fill)
+	{
+		size_t _tail = tail.load(std::memory_order_relaxed);
+		if (_tail - head.load(std::memory_order_acquire) > mask) {
+			return false;
+		}
+		_fill(items[_tail & mask]);
+		tail.store(_tail + 1, std::memory_order_seq_cst);
+		return true;
+	}
+
+	//ȡ_maxԪ,_out[0, n),n
+	size_t pop(T* _out, size_t _max)
+	{
+		size_t _head = head.load(std::memory_order_relaxed);
+		size_t n = std::min(tail.load(std::memory_order_acquire) - _head, _max);
+		for (size_t i = 0; i < n; i++) {
+			std::swap(_out[i], items[(_head + i) & mask]);
+		}
+		head.store(_head + n, std::memory_order_seq_cst);
+		return n;
+	}
+
+	bool empty()const {
+		return head.load(std::memory_order_seq_cst) == tail.load(std::memory_order_seq_cst);
+	}
+
+	bool full()const {
+		return tail.load(std::memory_order_seq_cst) - head.load(std::memory_order_seq_cst) > mask;
+	}
+};
+
+#ifdef __linux__
+//
+//һרӺͶȡ߳,pollȴsocket¼,ıɶȡ̷߳,Ӳᱻ߳ͬʱʹ
+//ϢƵɢе̵߳Ļζ,ͬһƵϢ˳,Ͷ·û
+//߳ÿȡһϢص,ʱȡ̵߳ȴ(ٶsocket,ɷеѹ)
+//ӶϿ˱ܼ,¶Ƶģʽ,ϿڼϢᶪʧ
+class redis_subscriber
+{
+public:
+	//ص,ÿmax_batch,Ϣڴڻصغᱻ
+	typedef std::function<void(redis_message* _messages, size_t _count)> handler_type;
+	//ص׳쳣,ڹ߳е,ϢͶ
+	typedef std::function<void(std::exception_ptr _error)> error_handler_type;
+protected:
+	struct worker {
+		redis_spsc_queue<redis_message> queue;
+		std::atomic<bool> sleeping;			//̵߳ȴϢ
+		std::atomic<bool> blocked;			//ȡ̵߳ȴпλ
+		std::mutex mutex;
+		std::condition_variable cond;
+		std::condition_variable space;
+		std::thread thread;
+
+		worker(size_t _queue_size) :queue(_queue_size), sleeping(false), blocked(false) {}
+	};
+
+	std::function<redisContext*()> connect;
+	handler_type handler;
+	error_handler_type error_handler;
+	size_t max_batch;
+	std::vector<std::unique_ptr<worker>> workers;
+
+	//״̬͵Ķı,ֻڶıʱ
+	std::mutex mutex;
+	std::set<std::string> channels;
+	std::set<std::string> patterns;
+	std::vector<std::pair<std::string, std::vector<std::string>>> pending;
+
+	redis_reconnect_loop loop;		//ȡ̵߳
+	std::atomic<bool> draining;		//ȡ߳Ѿ˳,߳ȡк˳
+	std::atomic<bool> online;
+	std::atomic<uint64_t> received;
+	std::atomic<uint64_t> handler_errors;
+	std::thread reader;
+
+	static size_t hash(const char* _str, size_t _len)
+	{
+		uint32_t _h = 2166136261u;
+		for (size_t i = 0; i < _len; i++) {
+			_h = (_h ^ (uint8_t)_str[i]) * 16777619u;
+		}
+		return _h;
+	}
+
+	void run_worker(worker& _worker)
+	{
+		std::vector<redis_message> _batch(max_batch);
+		for (;;)
+		{
+			size_t n = _worker.queue.pop(_batch.data(), _batch.size());
+			if (n > 0) {
+				if (_worker.blocked.load()) {
+					std::lock_guard<std::mutex> _lock(_worker.mutex);
+					_worker.space.notify_one();
+				}
+				try {
+					handler(_batch.data(), n);
+				}
+				catch (...) {
+					handler_errors++;
+					report(std::current_exception());
+				}
+				continue;
+			}
+			//drainingڶȡ߳˳,ʱв,ȡռ˳
+			if (draining.load()) {
+				if (_worker.queue.empty()) {
+					break;
+				}
+				continue;
+			}
+
+			//ȴټ,Ͷݷļ,ᶪʧ
+			std::unique_lock<std::mutex> _lock(_worker.mutex);
+			_worker.sleeping.store(true);
+			_worker.cond.wait(_lock, [&]() { return !_worker.queue.empty() || draining.load(); });
+			_worker.sleeping.store(false);
+		}
+	}
+
+	void report(std::exception_ptr _error)
+	{
+		if (error_handler) {
+			try {
+				error_handler(_error);
+			}
+			catch (...) {
+			}
+		}
+	}
+
+	//ͶһϢ,ʱȴ߳
+	bool post(const redisReply* _pattern, const redisReply* _channel, const redisReply* _payload)
+	{
+		worker& _worker = *workers[hash(_channel->str, _channel->len) % workers.size()];
+		auto _fill = [&](redis_message& _message) {
+			if (_pattern != nullptr) {
+				_message.pattern.assign(_pattern->str, _pattern->len);
+			}
+			else {
+				_message.pattern.clear();
+			}
+			_message.channel.assign(_channel->str, _channel->len);
+			_message.payload.assign(_payload->str, _payload->len);
+		};
+		while (!_worker.queue.try_push(_fill)) {
+			//ȴټ,빤߳ȡļ,ᶪʧ
+			std::unique_lock<std::mutex> _lock(_worker.mutex);
+			_worker.blocked.store(true);
+			_worker.space.wait(_lock, [&]() { return !_worker.queue.full() || loop.stopped(); });
+			_worker.blocked.store(false);
+			if (loop.stopped()) {
+				return false;
+			}
+		}
+		received++;
+		if (_worker.sleeping.load()) {
+			std::lock_guard<std::mutex> _lock(_worker.mutex);
+			_worker.cond.notify_one();
+		}
+		return true;
+	}
+
+	//ַһӦ,ֻmessage/pmessage/smessage,ȷϵȺ
+	void dispatch(const redisReply* _reply)
+	{
+		bool _array = _reply->type == REDIS_REPLY_ARRAY;
+#ifdef REDIS_REPLY_PUSH
+		_array = _array || _reply->type == REDIS_REPLY_PUSH;
+#endif
+		if (!_array || _reply->elements < 3 || _reply->element[0]->str == nullptr) {
+			return;
+		}
+		const redisReply* _kind = _reply->element[0];
+		if (_reply->elements == 3 && ((_kind->len == 7 && memcmp(_kind->str, "message", 7) == 0)
+			|| (_kind->len == 8 && memcmp(_kind->str, "smessage", 8) == 0))) {
+			post(nullptr, _reply->element[1], _reply->element[2]);
+		}
+		else if (_reply->elements == 4 && _kind->len == 8 && memcmp(_kind->str, "pmessage", 8) == 0) {
+			post(_reply->element[1], _reply->element[2], _reply->element[3]);
+		}
+	}
+
+	void send(redisContext* _context, const std::string& _cmd, const std::vector<std::string>& _argv)
+	{
+		if (_argv.empty()) {
+			return;
+		}
+		redis_append_command(_context, _cmd, _argv);
+		int _done = 0;
+		while (!_done) {
+			redis_test(redisBufferWrite(_context, &_done) == REDIS_OK, redis_error_code::command_error, _cmd);
+		}
+	}
+
+	void listen()
+	{
+		loop.run(connect, [this](redisContext* _context) { serve(_context); }, [this]() { online = false; });
+	}
+
+	void serve(redisContext* _context)
+	{
+		//¶ȫƵģʽ,֮ǰδ͵ıѾ
+		std::vector<std::string> _channels;
+		std::vector<std::string> _patterns;
+		{
+			std::lock_guard<std::mutex> _lock(mutex);
+			_channels.assign(channels.begin(), channels.end());
+			_patterns.assign(patterns.begin(), patterns.end());
+			pending.clear();
+		}
+		send(_context, "SUBSCRIBE", _channels);
+		send(_context, "PSUBSCRIBE", _patterns);
+		online = true;
+
+		while (!loop.stopped())
+		{
+			//ȴѾ뻺ĻӦ
+			for (;;) {
+				redisReply* _reply = nullptr;
+				redis_test(redisGetReplyFromReader(_context, (void**)&_reply) == REDIS_OK,
+					redis_error_code::command_error, "SUBSCRIBE");
+				if (_reply == nullptr) {
+					break;
+				}
+				dispatch(_reply);
+				redis_reply_arena::free_reply(_context, _reply);
+			}
+
+			bool _woken = false;
+			bool _readable = loop.wait(_context->fd, _woken);
+			if (_woken) {
+				std::vector<std::pair<std::string, std::vector<std::string>>> _pending;
+				{
+					std::lock_guard<std::mutex> _lock(mutex);
+					_pending.swap(pending);
+				}
+				for (auto& _change : _pending) {
+					send(_context, _change.first, _change.second);
+				}
+			}
+			if (_readable) {
+				redis_test(redisBufferRead(_context) == REDIS_OK, redis_error_code::command_error, "SUBSCRIBE");
+			}
+		}
+	}
+
+	//¼ıȡ̷߳
+	void change(const std::string& _cmd, std::set<std::string>& _set, bool _add, const std::vector<std::string>& _names)
+	{
+		{
+			std::lock_guard<std::mutex> _lock(mutex);
+			for (auto& _name : _names) {
+				if (_add) {
+					_set.insert(_name);
+				}
+				else {
+					_set.erase(_name);
+				}
+			}
+			pending.push_back(std::make_pair(_cmd, _names));
+		}
+		loop.wake();
+	}
+
+	redis_subscriber(const redis_subscriber&) = delete;
+	redis_subscriber& operator =(const redis_subscriber&) = delete;
+public:
+	//_connect𴴽һõ(AUTH),ϿҲ
+	//_workersΪصĹ߳,_queue_sizeΪÿ̵߳Ķг
+	//_error_handlerΪʱ_handler׳쳣
+	redis_subscriber(std::function<redisContext*()> _connect, handler_type _handler,
+		size_t _workers = 1, size_t _queue_size = 65536, size_t _max_batch = 256,
+		error_handler_type _error_handler = nullptr) :
+		connect(_connect), handler(_handler), error_handler(_error_handler), max_batch(_max_batch),
+		draining(false), online(false), received(0), handler_errors(0)
+	{
+		redis_test(_workers > 0 && _queue_size > 0 && _max_batch > 0);
+		for (size_t i = 0; i < _workers; i++) {
+			workers.emplace_back(new worker(_queue_size));
+		}
+		for (auto& _worker : workers) {
+			worker* _w = _worker.get();
+			_w->thread = std::thread([this, _w]() { run_worker(*_w); });
+		}
+		reader = std::thread([this]() { listen(); });
+	}
+
+	redis_subscriber(const std::string& _host, int _port, handler_type _handler,
+		size_t _workers = 1, size_t _queue_size = 65536, size_t _max_batch = 256,
+		error_handler_type _error_handler = nullptr) :
+		redis_subscriber([_host, _port]() {
+			redisContext* _context = redis_connect(_host, _port, std::chrono::milliseconds(1000));
+			if (_context != nullptr && !_context->err) {
+				//ϵĶȡʱ
+				struct timeval _none = { 0, 0 };
+				redisSetTimeout(_context, _none);
+			}
+			return _context;
+		}, _handler, _workers, _queue_size, _max_batch, _error_handler)
+	{
+	}
+
+	//ֹͣȡ,߳ͶʣϢ˳
+	//߳ڶȡ߳˳ſʼβ,ȡ߳ͶݵϢҲᶪʧ
+	~redis_subscriber()
+	{
+		loop.stop();
+		for (auto& _worker : workers) {
+			std::lock_guard<std::mutex> _lock(_worker->mutex);
+			_worker->space.notify_one();
+		}
+		reader.join();
+
+		draining = true;
+		for (auto& _worker : workers) {
+			{
+				std::lock_guard<std::mutex> _lock(_worker->mutex);
+				_worker->cond.notify_one();
+			}
+			_worker->thread.join();
+		}
+	}
+
+	void SUBSCRIBE(const std::vector<std::string>& _channels) {
+		change("SUBSCRIBE", channels, true, _channels);
+	}
+	void UNSUBSCRIBE(const std::vector<std::string>& _channels) {
+		change("UNSUBSCRIBE", channels, false, _channels);
+	}
+	void PSUBSCRIBE(const std::vector<std::string>& _patterns) {
+		change("PSUBSCRIBE", patterns, true, _patterns);
+	}
+	void PUNSUBSCRIBE(const std::vector<std::string>& _patterns) {
+		change("PUNSUBSCRIBE", patterns, false, _patterns);
+	}
+
+	//ӵǰǷ
+	bool connected()const { return online.load(); }
+
+	//Ͷݵ̵߳Ϣ
+	uint64_t received_count()const { return received.load(); }
+
+	//ص׳쳣
+	uint64_t handler_error_count()const { return handler_errors.load(); }
+};
+#endif
+
+/*
+	һ򵥵
+
+	redis_subscriber _subscriber("127.0.0.1", 6379, [](redis_message* _messages, size_t _count) {
+		for (size_t i = 0; i < _count; i++) {
+			//_messages[i].channel, _messages[i].payload
+		}
+	}, 4);
+	_subscriber.SUBSCRIBE({ "orders", "payments" });
+	_subscriber.PSUBSCRIBE({ "events.*" });
+*/
+
+#ifdef TC_REDIS
+}
+#endif
+
+#endif
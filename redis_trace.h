@@ -0,0 +1,168 @@
+#pragma once
+
+#ifndef __REDIS_TRACE_H__
+#define __REDIS_TRACE_H__
+
+#ifdef TC_REDIS
+namespace TC_REDIS {
+#endif
+
+//һĸ¼
+//beginʱֻcommand,keystart,endʱʱ,Ӧı
+struct redis_trace_event {
+	const std::string* command;
+	const char* key;					//һ(ַʱΪ),ָ÷ڴ,ֻڻصЧ
+	size_t key_len;
+	std::chrono::steady_clock::time_point start;
+	std::chrono::nanoseconds elapsed;
+	const redisReply* reply;			//ӴʱΪ
+	const std::string* text;			//ı,ֻڲ򳬹ֵʱȾ,Ϊ
+	bool sampled;
+
+	redis_trace_event() :command(nullptr), key(nullptr), key_len(0), elapsed(0), reply(nullptr), text(nullptr), sampled(false) {
+	}
+};
+
+//ٽӿ
+//ͬʱӼ߳ʹ,ص׳쳣
+class redis_tracer
+{
+protected:
+	std::chrono::nanoseconds slow;
+public:
+	//ʱС_slowendʱȾı
+	explicit redis_tracer(std::chrono::nanoseconds _slow = std::chrono::nanoseconds::max()) :slow(_slow) {
+	}
+	virtual ~redis_tracer() {}
+
+	std::chrono::nanoseconds slow_threshold()const { return slow; }
+
+	//ǰ,trueʱ(endʱȾı)
+	virtual bool begin(const redis_trace_event& /*_event*/) { return false; }
+	//յӦ
+	virtual void end(const redis_trace_event& _event) = 0;
+};
+
+//ĸ,ֻԲûص
+class redis_sampling_tracer : public redis_tracer
+{
+public:
+	typedef std::function<void(const redis_trace_event&)> handler_type;
+protected:
+	uint64_t sample_every;
+	std::atomic<uint64_t> counter;
+	handler_type handler;
+public:
+	//_sample_everyΪ0ʱ,ֻ
+	redis_sampling_tracer(std::chrono::nanoseconds _slow, uint64_t _sample_every, handler_type _handler) :
+		redis_tracer(_slow), sample_every(_sample_every), counter(0), handler(std::move(_handler))
+	{
+	}
+
+	bool begin(const redis_trace_event&) override {
+		return sample_every != 0 && counter.fetch_add(1, std::memory_order_relaxed) % sample_every == 0;
+	}
+
+	void end(const redis_trace_event& _event) override {
+		if (_event.text != nullptr) {
+			handler(_event);
+		}
+	}
+};
+
+//ȡһΪkey
+inline void redis_trace_key(redis_trace_event&) {}
+
+inline void redis_trace_set_key(redis_trace_event& _event, const std::string& _key) {
+	_event.key = _key.data();
+	_event.key_len = _key.size();
+}
+inline void redis_trace_set_key(redis_trace_event& _event, const char* _key) {
+	_event.key = _key;
+	_event.key_len = strlen(_key);
+}
+#ifdef REDIS_HAS_STRING_VIEW
+inline void redis_trace_set_key(redis_trace_event& _event, std::string_view _key) {
+	_event.key = _key.data();
+	_event.key_len = _key.size();
+}
+#endif
+inline void redis_trace_set_key(redis_trace_event& _event, const std::vector<std::string>& _argv) {
+	if (!_argv.empty()) {
+		redis_trace_set_key(_event, _argv.front());
+	}
+}
+inline void redis_trace_set_key(redis_trace_event& _event, const redis_command_args& _args) {
+	if (!_args.empty()) {
+		_event.key = _args[0].data;
+		_event.key_len = _args[0].size;
+	}
+}
+template<typename T>
+void redis_trace_set_key(redis_trace_event&, const T&) {}
+
+template<typename T, typename... ARGS>
+void redis_trace_key(redis_trace_event& _event, const T& _first, const ARGS&...) {
+	redis_trace_set_key(_event, _first);
+}
+
+//һĸ,ûtracerʱʲôҲ
+class redis_trace_scope
+{
+protected:
+	redis_tracer* tracer;
+	redis_trace_event event;
+
+	redis_trace_scope(const redis_trace_scope&) = delete;
+	redis_trace_scope& operator =(const redis_trace_scope&) = delete;
+public:
+	template<typename... ARGS>
+	redis_trace_scope(redis_tracer* _tracer, const std::string& _cmd, const ARGS&... _args) :tracer(_tracer)
+	{
+		if (tracer != nullptr) {
+			event.command = &_cmd;
+			redis_trace_key(event, _args...);
+			event.start = std::chrono::steady_clock::now();
+			event.sampled = tracer->begin(event);
+		}
+	}
+
+	//_render()ı,ֻڲʱ
+	template<typename RENDER>
+	void end(const redisReply* _reply, RENDER _render)
+	{
+		if (tracer == nullptr) {
+			return;
+		}
+		event.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - event.start);
+		event.reply = _reply;
+		std::string _text;
+		if (event.sampled || event.elapsed >= tracer->slow_threshold()) {
+			_text = _render();
+			event.text = &_text;
+		}
+		tracer->end(event);
+		tracer = nullptr;
+	}
+};
+
+/*
+	һ򵥵
+
+	//10ms1/1000Ĳд־
+	static redis_sampling_tracer _tracer(std::chrono::milliseconds(10), 1000, [](const redis_trace_event& _event) {
+		log("%s %lldus %s", _event.sampled ? "sample" : "slow",
+			(long long)(_event.elapsed.count() / 1000), _event.text->c_str());
+	});
+
+	redis_context _redis(_context, &_tracer);
+	_redis.hash().HGETALL("user:1");
+
+	redis_transaction _trans(_context, &_tracer);
+*/
+
+#ifdef TC_REDIS
+}
+#endif
+
+#endif
@@ -8,84 +8,138 @@ namespace TC_REDIS {
 #endif
 
 //redis
-//ύỺ浽,execʱһύ
+//ύappend_commandʱֱӱ뵽һRESP,execʱһύ
 class redis_transaction
 {
 protected:
 	redisContext* context;
-	std::deque<std::function<std::string()>> commands;
-
-	//תĲ
-	class redis_transaction_param_convert {
-	public:
-		template<typename T>
-		typename std::enable_if<std::is_integral<typename std::decay<T>::type>::value 
-			|| std::is_enum<typename std::decay<T>::type>::value, int64_t>::type
-			operator ()(T v) { return v; }
-
-		template<typename T>
-		typename std::enable_if<std::is_floating_point<typename std::decay<T>::type>::value,
-			double>::type
-			operator ()(T v) { return v; }
-
-		std::string operator ()(const char* v) { return v; }
-		const std::string& operator ()(const std::string& v) { return v; }
-	};
-
-	//ֵʽlambdaʽ
-	//еĲԿķʽ
-	template<typename... ARGS>
-	void append_command_converted(const std::string& _cmd, ARGS&&... _args) {
-		commands.push_back([=]() {
-			return redis_append_command(context, _cmd.c_str(), _args...);
-		});
+	redis_tracer* tracer;
+	std::string buffer;				//MULTI֮RESP
+	std::vector<size_t> offsets;	//ÿbufferеʼλ,ʱڻԭı
+
+	void reset()
+	{
+		buffer.clear();
+		offsets.clear();
+		redis_command_writer(buffer).command("MULTI");
+	}
+
+	//ӻԭiı,ڴϢ
+	std::string render(size_t i)const
+	{
+		const char* p = buffer.data() + offsets[i];
+		size_t _argc = (size_t)strtoull(p + 1, nullptr, 10);
+		p = strchr(p, '\n') + 1;
+
+		std::string _text;
+		for (size_t j = 0; j < _argc; j++) {
+			size_t _len = (size_t)strtoull(p + 1, nullptr, 10);
+			p = strchr(p, '\n') + 1;
+			_text.append(j == 0 ? "" : " ").append(p, _len);
+			p += _len + 2;
+		}
+		return _text;
+	}
+
+	//iĵj(0Ϊ),ʱؿմ
+	std::string argument(size_t i, size_t j)const
+	{
+		const char* p = buffer.data() + offsets[i];
+		size_t _argc = (size_t)strtoull(p + 1, nullptr, 10);
+		p = strchr(p, '\n') + 1;
+		for (size_t k = 0; k < _argc; k++) {
+			size_t _len = (size_t)strtoull(p + 1, nullptr, 10);
+			p = strchr(p, '\n') + 1;
+			if (k == j) {
+				return std::string(p, _len);
+			}
+			p += _len + 2;
+		}
+		return std::string();
+	}
+
+	//ı,ڸ
+	std::string render_all()const
+	{
+		std::string _text = "MULTI";
+		for (size_t i = 0; i < offsets.size(); i++) {
+			_text.append("; ").append(render(i));
+		}
+		return _text.append("; EXEC");
 	}
 public:
-	redis_transaction(redisContext* _context) :
-		context(_context)
+	//_tracerΪʱexecһbegin/end¼,keyΪһkey
+	redis_transaction(redisContext* _context, redis_tracer* _tracer = nullptr) :
+		context(_context), tracer(_tracer)
 	{
+		reset();
 	}
 	~redis_transaction() {}
 
 	//ʹòݹ
-	template<typename... ARGS, typename = std::enable_if<!is_redis_command_argv<typename std::decay<ARGS>::type...>::value>::type>
+	template<typename... ARGS, typename = typename std::enable_if<!is_redis_command_argv<typename std::decay<ARGS>::type...>::value>::type>
 	void append_command(const std::string& _cmd, ARGS&&... _args) {
-		append_command_converted(_cmd, redis_transaction_param_convert()(_args)...);
+		offsets.push_back(buffer.size());
+		redis_command_writer(buffer).command(_cmd, _args...);
 	}
 
 	//ʹstd::vector<std::string>ݹ
 	void append_command(const std::string& _cmd, const std::vector<std::string>& _argv) {
-		append_command_converted(_cmd, _argv);
+		offsets.push_back(buffer.size());
+		redis_command_writer(buffer).command(_cmd, _argv);
 	}
 
 
 	//ִ
 	//Զڶͷ MULTI 
 	//Զڶβ EXEC 
-	//һύ
+	//һд,ζȡӦ,ֻEXECĻӦ
 	redis_reply exec()
 	{
-		std::vector<std::string> _appends;
-		_appends.push_back(redis_append_command(context, "MULTI"));
-		for (auto& _cmd : commands) {
-			_appends.push_back(_cmd());
+		static const std::string _exec_cmd = "EXEC";
+		size_t _count = offsets.size();
+		std::string _key = tracer != nullptr && _count > 0 ? argument(0, 1) : std::string();
+		redis_trace_scope _trace(tracer, _exec_cmd, _key);
+
+		//۳ɹ׳쳣ύ,EXECڻﱻٴη
+		struct reset_guard {
+			redis_transaction* self;
+			~reset_guard() { self->reset(); }
+		} _guard{ this };
+
+		redis_command_writer(buffer).command("EXEC");
+		int ret = redisAppendFormattedCommand(context, buffer.data(), buffer.size());
+		redis_test(ret == REDIS_OK, redis_error_code::command_error, "MULTI");
+
+		//ȶлӦٱ,ӿ
+		bool _failed = false;
+		std::string _error;
+		std::string _error_cmd;
+		redis_reply _exec(nullptr);
+		try {
+			for (size_t i = 0; i <= _count; i++) {
+				redis_reply _reply = redis_get_reply(context);
+				const redisReply* _raw = _reply;
+				bool _ok = _raw != nullptr && _raw->type == REDIS_REPLY_STATUS
+					&& _stricmp(_raw->str, i == 0 ? "OK" : "QUEUED") == 0;
+				if (!_ok && !_failed) {
+					_failed = true;
+					_error = (_raw != nullptr && _raw->str != nullptr) ? std::string(_raw->str, _raw->len) : "";
+					_error_cmd = i == 0 ? "MULTI" : render(i - 1);
+				}
+			}
+			_exec = redis_get_reply(context, "EXEC");
 		}
-		commands.clear();
-		_appends.push_back(redis_append_command(context, "EXEC"));
-
-		std::vector<redis_reply> _replys;
-		for (auto& _cmd : _appends) {
-			redis_reply _reply = redis_get_reply(context, _cmd);
-			_replys.push_back(std::move(_reply));
+		catch (...) {
+			_trace.end(nullptr, [&]() { return render_all(); });
+			throw;
 		}
+		_trace.end(_exec, [&]() { return render_all(); });
 
-		redis_test(_replys[0].is_ok(),
-			redis_error_code::reply_is_error, _appends[0]);
-		for (size_t i = 1; i < _replys.size() - 1; i++) {
-			redis_test(_replys[i].is_queued(),
-				redis_error_code::reply_is_error, _appends[i]);
+		if (_failed) {
+			throw redis_error(redis_error_code::reply_is_error, _error, _error_cmd);
 		}
-		return std::move(_replys.back());
+		return _exec;
 	}
 
 	//ȡ
@@ -93,7 +147,7 @@ public:
 	//ʲôύ
 	redis_reply discard()
 	{
-		commands.clear();
+		reset();
 
 		auto _reply = new redisReply{ 0 };
 		_reply->type = REDIS_REPLY_STATUS;
@@ -112,6 +166,7 @@ inline redis_reply redis_watch(redisContext* _context,
 	uint32_t _retry_times,					//Դ
 	std::function<redis_reply()> _func)		//ִ
 {
+	redis_metrics::count_watch(false);
 	do
 	{
 		redis_test(
@@ -140,6 +195,7 @@ inline redis_reply redis_watch(redisContext* _context,
 			if (0 == _retry_times--) {
 				return std::move(_reply);
 			}
+			redis_metrics::count_watch(true);
 		}
 		else {
 			redis_test(false, redis_error_code::command_error, _reply.get_cmd());
@@ -0,0 +1,135 @@
+//ȺӵԲ,ʹtest/stubеhiredis
+//ڵ1slot 0-8191,ڵ2slot 8192-16383,key "b","c"ڽڵ1,"a"ڽڵ2
+
+#include "redis_stub.h"
+
+using namespace tc_redis;
+
+static redisReply* slots()
+{
+	using namespace redis_stub;
+	return array({
+		array({ integer(0), integer(8191), array({ string("h"), integer(1) }) }),
+		array({ integer(8192), integer(16383), array({ string("h"), integer(2) }) }),
+	});
+}
+
+static std::unique_ptr<redis_cluster_context> make_cluster()
+{
+	redis_stub::reset();
+	redis_stub::reply(1, slots());
+	return std::unique_ptr<redis_cluster_context>(new redis_cluster_context(
+		[](const std::string&, int _port) { return redis_stub::connect(_port); }, { { "h", 1 } }));
+}
+
+//INCRӶϿ,ط
+static void incr_not_resent()
+{
+	auto _cluster = make_cluster();
+	redis_stub::fail(1);
+	redis_stub::reply(1, redis_stub::integer(1));
+
+	bool _thrown = false;
+	try {
+		_cluster->string().INCR("b");
+	}
+	catch (const redis_error&) {
+		_thrown = true;
+	}
+	REDIS_CHECK(_thrown);
+	REDIS_CHECK(redis_stub::count(1, "INCR") == 1);
+}
+
+//GETӶϿ,ˢ˺ط
+static void get_resent()
+{
+	auto _cluster = make_cluster();
+	redis_stub::fail(1);
+	redis_stub::reply(1, slots());
+	redis_stub::reply(1, redis_stub::string("v"));
+
+	auto _value = _cluster->string().GET("b");
+	REDIS_CHECK(_value && *_value == "v");
+	REDIS_CHECK(redis_stub::count(1, "GET") == 2);
+	REDIS_CHECK(redis_stub::get(1).connects == 2);
+}
+
+//ASKʱĿڵȷASKING,slot
+static void ask_redirect()
+{
+	auto _cluster = make_cluster();
+	redis_stub::reply(1, redis_stub::error("ASK 3300 :3"));
+	redis_stub::reply(3, redis_stub::status("OK"));
+	redis_stub::reply(3, redis_stub::string("v"));
+	redis_stub::reply(1, redis_stub::string("w"));
+
+	auto _value = _cluster->string().GET("b");
+	REDIS_CHECK(_value && *_value == "v");
+	REDIS_CHECK((redis_stub::get(3).sent == std::vector<std::string>{ "ASKING", "GET b" }));
+
+	_value = _cluster->string().GET("b");
+	REDIS_CHECK(_value && *_value == "w");
+	REDIS_CHECK(redis_stub::count(1, "GET") == 2);
+}
+
+//ֵMGETһڵ϶ȡʧ,ֻԸýڵĲ,ԭ˳ϲ
+static void split_read_failure()
+{
+	auto _cluster = make_cluster();
+	redis_stub::fail(1);
+	redis_stub::reply(2, redis_stub::array({ redis_stub::string("va") }));
+	redis_stub::reply(1, redis_stub::array({ redis_stub::string("vb") }));
+
+	auto _values = _cluster->string().MGET(std::vector<std::string>{ "a", "b" });
+	REDIS_CHECK(_values.size() == 2 && _values[0] && *_values[0] == "va" && _values[1] && *_values[1] == "vb");
+	REDIS_CHECK(redis_stub::count(1, "MGET") == 2);
+	REDIS_CHECK(redis_stub::count(2, "MGET") == 1);
+}
+
+//ֵDELһڵ϶ȡʧ,ط
+static void split_write_not_resent()
+{
+	auto _cluster = make_cluster();
+	redis_stub::fail(1);
+	redis_stub::reply(2, redis_stub::integer(1));
+	redis_stub::reply(1, redis_stub::integer(1));
+
+	bool _thrown = false;
+	try {
+		_cluster->key().DEL(std::vector<std::string>{ "a", "b" });
+	}
+	catch (const redis_error&) {
+		_thrown = true;
+	}
+	REDIS_CHECK(_thrown);
+	REDIS_CHECK(redis_stub::count(1, "DEL") == 1);
+}
+
+//ڵ1ϵڶ׷ʧ,һֻ,Ӻָһ,෢
+static void split_append_failure()
+{
+	auto _cluster = make_cluster();
+	redis_stub::get(1).fail_append = 2;
+	redis_stub::reply(2, redis_stub::array({ redis_stub::string("va") }));
+	redis_stub::reply(1, redis_stub::array({ redis_stub::string("vb") }));
+	redis_stub::reply(1, redis_stub::array({ redis_stub::string("vc") }));
+
+	auto _values = _cluster->string().MGET(std::vector<std::string>{ "a", "b", "c" });
+	REDIS_CHECK(_values.size() == 3 && _values[0] && *_values[0] == "va"
+		&& _values[1] && *_values[1] == "vb" && _values[2] && *_values[2] == "vc");
+	REDIS_CHECK((redis_stub::get(1).sent == std::vector<std::string>{ "CLUSTER SLOTS", "MGET b", "MGET c" }));
+}
+
+int main()
+{
+	REDIS_CHECK(redis_cluster_slot::get("a") > 8191);
+	REDIS_CHECK(redis_cluster_slot::get("b") == 3300 && redis_cluster_slot::get("c") <= 8191);
+
+	incr_not_resent();
+	get_resent();
+	ask_redirect();
+	split_read_failure();
+	split_write_not_resent();
+	split_append_failure();
+	return g_failures;
+}
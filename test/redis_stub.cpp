@@ -0,0 +1,214 @@
+#include "redis_stub.h"
+
+int g_failures = 0;
+
+namespace redis_stub {
+
+//Ľڵ㼰
+struct connection {
+	int node;
+	std::string buffer;
+};
+
+static std::map<const redisContext*, connection>& connections() {
+	static std::map<const redisContext*, connection> _connections;
+	return _connections;
+}
+
+static node& node_of(const redisContext* _context) {
+	return get(connections()[_context].node);
+}
+
+static std::map<int, node>& nodes() {
+	static std::map<int, node> _nodes;
+	return _nodes;
+}
+
+void reset() {
+	nodes().clear();
+}
+
+node& get(int _node) {
+	return nodes()[_node];
+}
+
+redisContext* connect(int _node, int _fd)
+{
+	redisContext* _context = (redisContext*)calloc(1, sizeof(redisContext));
+	_context->fd = _fd;
+	get(_node).connects++;
+	connections()[_context] = connection{ _node, std::string() };
+	return _context;
+}
+
+static redisReply* make(int _type) {
+	redisReply* _reply = (redisReply*)calloc(1, sizeof(redisReply));
+	_reply->type = _type;
+	return _reply;
+}
+
+static redisReply* make(int _type, const std::string& _str) {
+	redisReply* _reply = make(_type);
+	_reply->str = (char*)malloc(_str.size() + 1);
+	memcpy(_reply->str, _str.c_str(), _str.size() + 1);
+	_reply->len = _str.size();
+	return _reply;
+}
+
+redisReply* string(const std::string& _str) { return make(REDIS_REPLY_STRING, _str); }
+redisReply* status(const std::string& _str) { return make(REDIS_REPLY_STATUS, _str); }
+redisReply* error(const std::string& _str) { return make(REDIS_REPLY_ERROR, _str); }
+redisReply* nil() { return make(REDIS_REPLY_NIL); }
+
+redisReply* integer(long long _value)
+{
+	redisReply* _reply = make(REDIS_REPLY_INTEGER);
+	_reply->integer = _value;
+	return _reply;
+}
+
+redisReply* array(const std::vector<redisReply*>& _elements)
+{
+	redisReply* _reply = make(REDIS_REPLY_ARRAY);
+	_reply->elements = _elements.size();
+	_reply->element = (redisReply**)calloc(_elements.size() + 1, sizeof(redisReply*));
+	for (size_t i = 0; i < _elements.size(); i++) {
+		_reply->element[i] = _elements[i];
+	}
+	return _reply;
+}
+
+void reply(int _node, redisReply* _reply) {
+	get(_node).replies.push_back(step{ _reply });
+}
+
+void fail(int _node) {
+	get(_node).replies.push_back(step{ nullptr });
+}
+
+size_t count(int _node, const std::string& _cmd)
+{
+	size_t _count = 0;
+	for (auto& _sent : get(_node).sent) {
+		if (_sent.compare(0, _sent.find(' '), _cmd) == 0) {
+			_count++;
+		}
+	}
+	return _count;
+}
+
+//еRESPıڵ
+static void flush(redisContext* _context)
+{
+	std::string& _buffer = connections()[_context].buffer;
+	const char* p = _buffer.c_str();
+	const char* _end = p + _buffer.size();
+	while (p < _end) {
+		size_t _argc = (size_t)strtoull(p + 1, nullptr, 10);
+		p = strchr(p, '\n') + 1;
+		std::string _text;
+		for (size_t i = 0; i < _argc; i++) {
+			size_t _len = (size_t)strtoull(p + 1, nullptr, 10);
+			p = strchr(p, '\n') + 1;
+			_text.append(i == 0 ? "" : " ").append(p, _len);
+			p += _len + 2;
+		}
+		node_of(_context).sent.push_back(_text);
+	}
+	_buffer.clear();
+}
+
+}
+
+using namespace redis_stub;
+
+extern "C" {
+
+void freeReplyObject(void* _reply)
+{
+	redisReply* r = (redisReply*)_reply;
+	if (r == nullptr) {
+		return;
+	}
+	for (size_t i = 0; i < r->elements; i++) {
+		freeReplyObject(r->element[i]);
+	}
+	free(r->element);
+	free(r->str);
+	free(r);
+}
+
+void redisFree(redisContext* _context)
+{
+	connections().erase(_context);
+	free(_context);
+}
+
+int redisAppendFormattedCommand(redisContext* _context, const char* _cmd, size_t _len)
+{
+	node& _node = node_of(_context);
+	if (_node.fail_append > 0 && --_node.fail_append == 0) {
+		return REDIS_ERR;
+	}
+	connections()[_context].buffer.append(_cmd, _len);
+	return REDIS_OK;
+}
+
+int redisBufferWrite(redisContext* _context, int* _done)
+{
+	flush(_context);
+	*_done = 1;
+	return REDIS_OK;
+}
+
+int redisGetReply(redisContext* _context, void** _reply)
+{
+	flush(_context);
+	*_reply = nullptr;
+	node& _node = node_of(_context);
+	if (_context->err) {
+		return REDIS_ERR;
+	}
+	if (_node.replies.empty() || _node.replies.front().reply == nullptr) {
+		if (!_node.replies.empty()) {
+			_node.replies.pop_front();
+		}
+		_context->err = 1;
+		strcpy(_context->errstr, "stub read failed");
+		return REDIS_ERR;
+	}
+	*_reply = _node.replies.front().reply;
+	_node.replies.pop_front();
+	return REDIS_OK;
+}
+
+int redisGetReplyFromReader(redisContext* _context, void** _reply)
+{
+	*_reply = nullptr;
+	node& _node = node_of(_context);
+	if (!_node.replies.empty() && _node.replies.front().reply != nullptr) {
+		if (_node.read_delay_us > 0) {
+			std::this_thread::sleep_for(std::chrono::microseconds(_node.read_delay_us));
+		}
+		*_reply = _node.replies.front().reply;
+		_node.replies.pop_front();
+	}
+	return REDIS_OK;
+}
+
+int redisBufferRead(redisContext*) { return REDIS_OK; }
+int redisSetTimeout(redisContext*, const struct timeval) { return REDIS_OK; }
+redisContext* redisConnectWithTimeout(const char*, int _port, const struct timeval) { return connect(_port); }
+redisPushFn* redisSetPushCallback(redisContext*, redisPushFn*) { return nullptr; }
+
+redisAsyncContext* redisAsyncConnect(const char*, int) { return nullptr; }
+int redisAsyncSetConnectCallback(redisAsyncContext*, redisConnectCallback*) { return REDIS_ERR; }
+int redisAsyncSetDisconnectCallback(redisAsyncContext*, redisDisconnectCallback*) { return REDIS_ERR; }
+void redisAsyncDisconnect(redisAsyncContext*) {}
+void redisAsyncFree(redisAsyncContext*) {}
+void redisAsyncHandleRead(redisAsyncContext*) {}
+void redisAsyncHandleWrite(redisAsyncContext*) {}
+void redisAsyncHandleTimeout(redisAsyncContext*) {}
+int redisAsyncFormattedCommand(redisAsyncContext*, redisCallbackFn*, void*, const char*, size_t) { return REDIS_ERR; }
+
+}
@@ -0,0 +1,53 @@
+//õhiredis
+//ÿһڵ(Ⱥм˿ں),дӵ,ˢºڵѷͼ¼
+//redisFreeδˢµ,hiredisһ,ڼϿʱ
+//ӦڵŶ,Բȡʧ(err)׷ʧ
+
+#pragma once
+
+#include "redis_ex.h"
+#include <cstdio>
+
+namespace redis_stub {
+
+//ڵŶӵһӦ,replyΪnullptrʱʾȡʧ
+struct step {
+	redisReply* reply;
+};
+
+struct node {
+	std::deque<step> replies;
+	std::vector<std::string> sent;		//ˢµ,ÿΪոָĲ
+	int fail_append;					//>0ʱfail_append׷ʧ
+	int read_delay_us;					//redisGetReplyFromReaderÿȡһǰȴ΢
+	int connects;
+};
+
+//нڵ
+void reset();
+node& get(int _node);
+
+//һڵ_node,_fdҪpollĵʹ
+redisContext* connect(int _node, int _fd = -1);
+
+//Ӧ
+redisReply* string(const std::string& _str);
+redisReply* status(const std::string& _str);
+redisReply* error(const std::string& _str);
+redisReply* integer(long long _value);
+redisReply* nil();
+redisReply* array(const std::vector<redisReply*>& _elements);
+
+//ڽڵŶһӦһζȡʧ
+void reply(int _node, redisReply* _reply);
+void fail(int _node);
+
+//ڵѷ͵Ϊ_cmd
+size_t count(int _node, const std::string& _cmd);
+
+}
+
+//ʧʱ¼,mainʧ
+extern int g_failures;
+#define REDIS_CHECK(_exp) \
+	do { if (!(_exp)) { g_failures++; printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #_exp); } } while (0)
@@ -0,0 +1,131 @@
+//߻ζеֲ,ʹtest/stubеhiredis
+//ϢԤڽڵ,ȡ߳һȡpollϵȴ(ܵɶ),ֻܻ
+
+#include "redis_stub.h"
+#include <unistd.h>
+
+using namespace tc_redis;
+
+static int g_pipe[2];
+
+static redisReply* message(const std::string& _channel, size_t _seq)
+{
+	using namespace redis_stub;
+	return array({ string("message"), string(_channel), string(std::to_string(_seq)) });
+}
+
+static std::function<redisContext*()> connector()
+{
+	return []() { return redis_stub::connect(1, g_pipe[0]); };
+}
+
+static bool wait_for(const std::function<bool()>& _done)
+{
+	auto _deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while (!_done()) {
+		if (std::chrono::steady_clock::now() > _deadline) {
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
+//ֻ2λ,ȡ̷߳ȴλ,̷߳ȴϢ,ܶʧ,˳򲻱
+static void backpressure()
+{
+	redis_stub::reset();
+	const size_t _count = 2000;
+	for (size_t i = 0; i < _count; i++) {
+		redis_stub::reply(1, message("ch", i));
+	}
+
+	std::atomic<size_t> _handled(0);
+	std::atomic<bool> _ordered(true);
+	redis_subscriber _subscriber(connector(), [&](redis_message* _messages, size_t n) {
+		for (size_t i = 0; i < n; i++) {
+			if (_messages[i].payload != std::to_string(_handled.load())) {
+				_ordered = false;
+			}
+			_handled++;
+		}
+		if (_handled % 64 == 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}, 1, 2, 1);
+
+	REDIS_CHECK(wait_for([&]() { return _handled.load() == _count; }));
+	REDIS_CHECK(_ordered.load());
+	REDIS_CHECK(_subscriber.received_count() == _count);
+}
+
+//ʱȡ̻߳ͶݻеϢ,߳Ҫȶȡ߳˳ȡ,ܶʧ
+static void drain_on_shutdown()
+{
+	redis_stub::reset();
+	const size_t _count = 2000;
+	for (size_t i = 0; i < _count; i++) {
+		redis_stub::reply(1, message("ch", i));
+	}
+	redis_stub::get(1).read_delay_us = 100;
+
+	std::atomic<size_t> _handled(0);
+	{
+		redis_subscriber _subscriber(connector(), [&](redis_message*, size_t n) {
+			_handled += n;
+		}, 1, 4096, 16);
+		REDIS_CHECK(wait_for([&]() { return _handled.load() > 0; }));
+	}
+	REDIS_CHECK(_handled.load() == _count);
+}
+
+//ȡ߳ϵȴʱ,ܹ
+static void shutdown_while_blocked()
+{
+	redis_stub::reset();
+	for (size_t i = 0; i < 100; i++) {
+		redis_stub::reply(1, message("ch", i));
+	}
+
+	std::atomic<size_t> _handled(0);
+	{
+		redis_subscriber _subscriber(connector(), [&](redis_message*, size_t n) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			_handled += n;
+		}, 1, 2, 1);
+		REDIS_CHECK(wait_for([&]() { return _handled.load() > 0; }));
+	}
+	REDIS_CHECK(_handled.load() < 100);
+}
+
+//ص׳쳣_error_handler,̼߳Ϣ
+static void handler_errors()
+{
+	redis_stub::reset();
+	for (size_t i = 0; i < 10; i++) {
+		redis_stub::reply(1, message(i % 2 ? "bad" : "ch", i));
+	}
+
+	std::atomic<size_t> _handled(0);
+	std::atomic<size_t> _reported(0);
+	redis_subscriber _subscriber(connector(), [&](redis_message* _messages, size_t n) {
+		_handled += n;
+		if (_messages[0].channel == "bad") {
+			throw std::runtime_error("bad");
+		}
+	}, 1, 16, 1, [&](std::exception_ptr) { _reported++; });
+
+	REDIS_CHECK(wait_for([&]() { return _handled.load() == 10; }));
+	REDIS_CHECK(wait_for([&]() { return _reported.load() == 5; }));
+	REDIS_CHECK(_subscriber.handler_error_count() == 5);
+}
+
+int main()
+{
+	REDIS_CHECK(pipe(g_pipe) == 0);
+	backpressure();
+	drain_on_shutdown();
+	shutdown_while_blocked();
+	handler_errors();
+	return g_failures;
+}
@@ -0,0 +1,24 @@
+//õhiredis첽ӿ,ʵredis_stub.cpp
+#pragma once
+#include "hiredis.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+struct redisAsyncContext;
+typedef void (redisCallbackFn)(struct redisAsyncContext*, void*, void*);
+typedef void (redisDisconnectCallback)(const struct redisAsyncContext*, int status);
+typedef void (redisConnectCallback)(const struct redisAsyncContext*, int status);
+typedef struct redisAsyncContext { redisContext c; int err; char *errstr; void *data; void (*dataCleanup)(void *privdata);
+ struct { void *data; void (*addRead)(void *privdata); void (*delRead)(void *privdata); void (*addWrite)(void *privdata); void (*delWrite)(void *privdata); void (*cleanup)(void *privdata); void (*scheduleTimer)(void *privdata, struct timeval tv); } ev; } redisAsyncContext;
+redisAsyncContext *redisAsyncConnect(const char *ip, int port);
+int redisAsyncSetConnectCallback(redisAsyncContext *ac, redisConnectCallback *fn);
+int redisAsyncSetDisconnectCallback(redisAsyncContext *ac, redisDisconnectCallback *fn);
+void redisAsyncDisconnect(redisAsyncContext *ac);
+void redisAsyncFree(redisAsyncContext *ac);
+void redisAsyncHandleRead(redisAsyncContext *ac);
+void redisAsyncHandleWrite(redisAsyncContext *ac);
+void redisAsyncHandleTimeout(redisAsyncContext *ac);
+int redisAsyncFormattedCommand(redisAsyncContext *ac, redisCallbackFn *fn, void *privdata, const char *cmd, size_t len);
+#ifdef __cplusplus
+}
+#endif
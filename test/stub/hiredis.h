@@ -0,0 +1,57 @@
+//õhiredis,ֻredis_exõĲ,ʵredis_stub.cpp
+#pragma once
+#include <stddef.h>
+#include <stdarg.h>
+#include <sys/time.h>
+#define REDIS_OK 0
+#define REDIS_ERR -1
+#define REDIS_REPLY_STRING 1
+#define REDIS_REPLY_ARRAY 2
+#define REDIS_REPLY_INTEGER 3
+#define REDIS_REPLY_NIL 4
+#define REDIS_REPLY_STATUS 5
+#define REDIS_REPLY_ERROR 6
+#define REDIS_REPLY_DOUBLE 7
+#define REDIS_REPLY_BOOL 8
+#define REDIS_REPLY_MAP 9
+#define REDIS_REPLY_SET 10
+#define REDIS_REPLY_ATTR 11
+#define REDIS_REPLY_PUSH 12
+#define REDIS_REPLY_BIGNUM 13
+#define REDIS_REPLY_VERB 14
+#define REDIS_NO_AUTO_FREE_REPLIES 0x200
+#ifdef __cplusplus
+extern "C" {
+#endif
+typedef struct redisReply { int type; long long integer; double dval; size_t len; char *str; char vtype[4]; size_t elements; struct redisReply **element; } redisReply;
+typedef struct redisReadTask { int type; long long elements; int idx; void *obj; struct redisReadTask *parent; void *privdata; } redisReadTask;
+typedef struct redisReplyObjectFunctions {
+ void *(*createString)(const redisReadTask*, char*, size_t);
+ void *(*createArray)(const redisReadTask*, size_t);
+ void *(*createInteger)(const redisReadTask*, long long);
+ void *(*createDouble)(const redisReadTask*, double, char*, size_t);
+ void *(*createNil)(const redisReadTask*);
+ void *(*createBool)(const redisReadTask*, int);
+ void (*freeObject)(void*);
+} redisReplyObjectFunctions;
+typedef struct redisReader { int err; char errstr[128]; char *buf; size_t pos; size_t len; size_t maxbuf; long long maxelements; redisReadTask **task; int tasks; int ridx; void *reply; redisReplyObjectFunctions *fn; void *privdata; } redisReader;
+typedef void (redisPushFn)(void *, void *);
+typedef struct redisContext { int err; char errstr[128]; int fd; int flags; char *obuf; redisReader *reader; void *privdata; void (*free_privdata)(void *); redisPushFn *push_cb; } redisContext;
+void freeReplyObject(void *reply);
+redisContext *redisConnectWithTimeout(const char *ip, int port, const struct timeval tv);
+void redisFree(redisContext *c);
+int redisSetTimeout(redisContext *c, const struct timeval tv);
+int redisBufferRead(redisContext *c);
+int redisBufferWrite(redisContext *c, int *done);
+int redisGetReply(redisContext *c, void **reply);
+int redisGetReplyFromReader(redisContext *c, void **reply);
+int redisAppendFormattedCommand(redisContext *c, const char *cmd, size_t len);
+void *redisCommand(redisContext *c, const char *format, ...);
+int redisAppendCommand(redisContext *c, const char *format, ...);
+int redisvFormatCommand(char **target, const char *format, va_list ap);
+int redisFormatCommand(char **target, const char *format, ...);
+void redisFreeCommand(char *cmd);
+redisPushFn *redisSetPushCallback(redisContext *c, redisPushFn *fn);
+#ifdef __cplusplus
+}
+#endif